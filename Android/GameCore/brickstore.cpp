@@ -0,0 +1,455 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#if defined(__AVX2__)
+#define BRICK_KERNEL_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BRICK_KERNEL_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define BRICK_KERNEL_NEON
+#include <arm_neon.h>
+#endif
+
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "brickstore.h"
+
+namespace
+{
+// returns position of the lowest set bit of non-zero mask
+inline unsigned lowestBit(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return unsigned(__builtin_ctz(mask));
+#endif
+}
+
+// returns number of set bits of lane mask
+inline unsigned bitCount(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned count = 0;
+    for (; 0 != mask; mask &= mask - 1)
+    {
+        count ++;
+    }
+    return count;
+#else
+    return unsigned(__builtin_popcount(mask));
+#endif
+}
+
+#if defined(BRICK_KERNEL_NEON)
+// returns bit per byte lane of comparison result, NEON has no movemask
+inline unsigned byteBits(uint8x16_t mask)
+{
+    static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint64x2_t sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(mask, vld1q_u8(weights)))));
+    return unsigned(vgetq_lane_u64(sums, 0)) | unsigned(vgetq_lane_u64(sums, 1)) << 8;
+}
+#endif
+}
+
+BrickStore::BrickStore() :
+    x_(nullptr),
+    y_(nullptr),
+    kind_(nullptr),
+    bonus_(nullptr),
+    shrinkTime_(nullptr),
+    flags_(nullptr),
+    releasedBonuses_(nullptr),
+    scaledSlots_(nullptr),
+    scales_(nullptr),
+    collapsed_(nullptr)
+{
+}
+
+void BrickStore::Initialize(LevelArena& arena, unsigned capacity)
+{
+    map_.Initialize(arena, capacity);
+    x_ = arena.AllocateArray<float>(capacity);
+    y_ = arena.AllocateArray<float>(capacity);
+    kind_ = arena.AllocateArray<unsigned char>(capacity);
+    bonus_ = arena.AllocateArray<EntityHandle>(capacity);
+    shrinkTime_ = arena.AllocateArray<float>(capacity);
+    flags_ = arena.AllocateArray<unsigned char>(capacity);
+    releasedBonuses_ = arena.AllocateArray<EntityHandle>(capacity);
+    scaledSlots_ = arena.AllocateArray<unsigned>(capacity);
+    scales_ = arena.AllocateArray<float>(capacity);
+    collapsed_ = arena.AllocateArray<EntityHandle>(capacity);
+}
+
+void BrickStore::Clear()
+{
+    map_.Clear();
+    x_ = y_ = nullptr;
+    kind_ = nullptr;
+    bonus_ = nullptr;
+    shrinkTime_ = nullptr;
+    flags_ = nullptr;
+    releasedBonuses_ = nullptr;
+    scaledSlots_ = nullptr;
+    scales_ = nullptr;
+    collapsed_ = nullptr;
+}
+
+EntityHandle BrickStore::Add(float x, float y, unsigned char kind, EntityHandle bonus)
+{
+    EntityHandle handle = map_.Add();
+    if (NULL_HANDLE != handle)
+    {
+        unsigned index = map_.Size() - 1;
+        x_[index] = x;
+        y_[index] = y;
+        kind_[index] = kind;
+        bonus_[index] = bonus;
+        shrinkTime_[index] = 0;
+        flags_[index] = 0;
+    }
+    return handle;
+}
+
+bool BrickStore::Remove(EntityHandle handle)
+{
+    unsigned removed, movedFrom;
+    if (false == map_.Remove(handle, removed, movedFrom))
+    {
+        return false;
+    }
+    x_[removed] = x_[movedFrom];
+    y_[removed] = y_[movedFrom];
+    kind_[removed] = kind_[movedFrom];
+    bonus_[removed] = bonus_[movedFrom];
+    shrinkTime_[removed] = shrinkTime_[movedFrom];
+    flags_[removed] = flags_[movedFrom];
+    return true;
+}
+
+void BrickStore::Hit(EntityHandle handle)
+{
+    if (false != map_.IsValid(handle))
+    {
+        unsigned index = map_.GetIndex(handle);
+        // only intact brick starts collapsing
+        if (0 == flags_[index])
+        {
+            flags_[index] = BRICK_HIT | BRICK_SHRINKING;
+            shrinkTime_[index] = SHRINK_TIME;
+        }
+    }
+}
+
+const char* BrickStore::GetKernelName()
+{
+#if defined(BRICK_KERNEL_AVX2)
+    return "AVX2";
+#elif defined(BRICK_KERNEL_SSE2)
+    return "SSE2";
+#elif defined(BRICK_KERNEL_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+void BrickStore::processBrick(unsigned index, PassState& state)
+{
+    unsigned char flags = flags_[index];
+    if (0 == flags)
+    {
+        state.remaining_ ++;
+        return;
+    }
+    // hit brick releases its score and bonus
+    if (0 != (flags & BRICK_HIT))
+    {
+        state.hitCount_ ++;
+        if (NULL_HANDLE != bonus_[index])
+        {
+            releasedBonuses_[state.releasedCount_ ++] = bonus_[index];
+        }
+    }
+    // shrinking brick reports new scale, and collapses when its timer runs out
+    if (0 != (flags & BRICK_SHRINKING))
+    {
+        scaledSlots_[state.scaledCount_] = map_.GetSlot(index);
+        scales_[state.scaledCount_] = shrinkTime_[index] * (1.0f / SHRINK_TIME);
+        state.scaledCount_ ++;
+        if (shrinkTime_[index] <= 0)
+        {
+            flags = BRICK_COLLAPSED;
+            collapsed_[state.collapsedCount_ ++] = map_.GetHandle(index);
+        }
+    }
+    if (0 == (flags & (BRICK_HIT | BRICK_COLLAPSED)))
+    {
+        state.remaining_ ++;
+    }
+    flags_[index] = flags & ~BRICK_HIT;
+}
+
+void BrickStore::finishPass(const PassState& state, BrickUpdateResult& result)
+{
+    result.scores_ = state.hitCount_ * BRICK_SCORES;
+    result.releasedBonuses_ = releasedBonuses_;
+    result.releasedCount_ = state.releasedCount_;
+    result.scaledSlots_ = scaledSlots_;
+    result.scales_ = scales_;
+    result.scaledCount_ = state.scaledCount_;
+    result.collapsed_ = collapsed_;
+    result.collapsedCount_ = state.collapsedCount_;
+    result.remaining_ = state.remaining_;
+}
+
+void BrickStore::UpdateScalar(float timeStep, BrickUpdateResult& result)
+{
+    PassState state = { 0, 0, 0, 0, 0 };
+    unsigned count = map_.Size();
+    for (unsigned i = 0; i < count; i ++)
+    {
+        float shrinkTime = shrinkTime_[i] - timeStep;
+        shrinkTime_[i] = shrinkTime > 0 ? shrinkTime : 0;
+        processBrick(i, state);
+    }
+    finishPass(state, result);
+}
+
+void BrickStore::Update(float timeStep, BrickUpdateResult& result)
+{
+    PassState state = { 0, 0, 0, 0, 0 };
+    updatePass(timeStep, 0, map_.Size(), state);
+    finishPass(state, result);
+}
+
+void BrickStore::UpdateRange(float timeStep, unsigned begin, unsigned end, BrickRangeResult& range)
+{
+    // output positions start at range begin, a range never emits more entries than it has bricks
+    PassState state = { 0, begin, begin, begin, 0 };
+    updatePass(timeStep, begin, end, state);
+    range.begin_ = begin;
+    range.hitCount_ = state.hitCount_;
+    range.releasedCount_ = state.releasedCount_ - begin;
+    range.scaledCount_ = state.scaledCount_ - begin;
+    range.collapsedCount_ = state.collapsedCount_ - begin;
+    range.remaining_ = state.remaining_;
+}
+
+void BrickStore::MergeRanges(const BrickRangeResult* ranges, unsigned count, BrickUpdateResult& result)
+{
+    PassState state = { 0, 0, 0, 0, 0 };
+    for (unsigned i = 0; i < count; i ++)
+    {
+        // packed data never reaches beyond begin of the next range, so moving forward is safe
+        const BrickRangeResult& range = ranges[i];
+        memmove(releasedBonuses_ + state.releasedCount_, releasedBonuses_ + range.begin_, range.releasedCount_ * sizeof(EntityHandle));
+        memmove(scaledSlots_ + state.scaledCount_, scaledSlots_ + range.begin_, range.scaledCount_ * sizeof(unsigned));
+        memmove(scales_ + state.scaledCount_, scales_ + range.begin_, range.scaledCount_ * sizeof(float));
+        memmove(collapsed_ + state.collapsedCount_, collapsed_ + range.begin_, range.collapsedCount_ * sizeof(EntityHandle));
+        state.hitCount_ += range.hitCount_;
+        state.releasedCount_ += range.releasedCount_;
+        state.scaledCount_ += range.scaledCount_;
+        state.collapsedCount_ += range.collapsedCount_;
+        state.remaining_ += range.remaining_;
+    }
+    finishPass(state, result);
+}
+
+void BrickStore::emitBlock(unsigned first, const BlockMasks& masks, const float* scales, PassState& state)
+{
+    state.hitCount_ += bitCount(masks.hit_);
+    state.remaining_ += bitCount(masks.remaining_);
+    // every result array gets its entries in index order, same as processBrick() emits them
+    for (unsigned hit = masks.hit_; 0 != hit; hit &= hit - 1)
+    {
+        unsigned index = first + lowestBit(hit);
+        if (NULL_HANDLE != bonus_[index])
+        {
+            releasedBonuses_[state.releasedCount_ ++] = bonus_[index];
+        }
+    }
+    for (unsigned shrinking = masks.shrinking_; 0 != shrinking; shrinking &= shrinking - 1)
+    {
+        unsigned lane = lowestBit(shrinking);
+        scaledSlots_[state.scaledCount_] = map_.GetSlot(first + lane);
+        scales_[state.scaledCount_] = scales[lane];
+        state.scaledCount_ ++;
+    }
+    for (unsigned collapsed = masks.collapsed_; 0 != collapsed; collapsed &= collapsed - 1)
+    {
+        collapsed_[state.collapsedCount_ ++] = map_.GetHandle(first + lowestBit(collapsed));
+    }
+}
+
+// vector kernels advance timers and compute scales of a block of bricks in float lanes, narrow their collapse test to
+// byte lanes and derive hit, shrinking, collapse and remaining masks and new flags in byte lanes, the same as
+// processBrick() does per brick; only compaction of events into result arrays runs per changed brick
+void BrickStore::updatePass(float timeStep, unsigned begin, unsigned end, PassState& state)
+{
+    unsigned i = begin;
+#if defined(BRICK_KERNEL_AVX2)
+    const __m256i zeroBytes = _mm256_setzero_si256();
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 step = _mm256_set1_ps(timeStep);
+    const __m256 scaleFactor = _mm256_set1_ps(1.0f / SHRINK_TIME);
+    const __m256i hitBit = _mm256_set1_epi8(BRICK_HIT);
+    const __m256i shrinkingBit = _mm256_set1_epi8(BRICK_SHRINKING);
+    const __m256i collapsedBit = _mm256_set1_epi8(BRICK_COLLAPSED);
+    const __m256i hitOrCollapsed = _mm256_set1_epi8(BRICK_HIT | BRICK_COLLAPSED);
+    // packing works within 128 bit halves, this puts 4 byte groups back into brick order
+    const __m256i packOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    float scales[32];
+    for (; i + 32 <= end; i += 32)
+    {
+        // intact bricks have zero flags and zero timers, whole block of them needs no work
+        __m256i flags = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(flags_ + i));
+        if (-1 == _mm256_movemask_epi8(_mm256_cmpeq_epi8(flags, zeroBytes)))
+        {
+            state.remaining_ += 32;
+            continue;
+        }
+        __m256i timedOut[4];
+        for (unsigned j = 0; j < 4; j ++)
+        {
+            __m256 shrinkTime = _mm256_max_ps(_mm256_sub_ps(_mm256_loadu_ps(shrinkTime_ + i + j * 8), step), zero);
+            _mm256_storeu_ps(shrinkTime_ + i + j * 8, shrinkTime);
+            _mm256_storeu_ps(scales + j * 8, _mm256_mul_ps(shrinkTime, scaleFactor));
+            timedOut[j] = _mm256_castps_si256(_mm256_cmp_ps(shrinkTime, zero, _CMP_LE_OQ));
+        }
+        __m256i timedOutBytes = _mm256_packs_epi16(_mm256_packs_epi32(timedOut[0], timedOut[1]),
+                                                   _mm256_packs_epi32(timedOut[2], timedOut[3]));
+        timedOutBytes = _mm256_permutevar8x32_epi32(timedOutBytes, packOrder);
+        __m256i hit = _mm256_cmpeq_epi8(_mm256_and_si256(flags, hitBit), hitBit);
+        __m256i shrinking = _mm256_cmpeq_epi8(_mm256_and_si256(flags, shrinkingBit), shrinkingBit);
+        __m256i collapse = _mm256_and_si256(shrinking, timedOutBytes);
+        __m256i newFlags = _mm256_blendv_epi8(flags, collapsedBit, collapse);
+        __m256i remaining = _mm256_cmpeq_epi8(_mm256_and_si256(newFlags, hitOrCollapsed), zeroBytes);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(flags_ + i), _mm256_andnot_si256(hitBit, newFlags));
+        BlockMasks masks =
+        {
+            unsigned(_mm256_movemask_epi8(hit)),
+            unsigned(_mm256_movemask_epi8(shrinking)),
+            unsigned(_mm256_movemask_epi8(collapse)),
+            unsigned(_mm256_movemask_epi8(remaining))
+        };
+        emitBlock(i, masks, scales, state);
+    }
+#elif defined(BRICK_KERNEL_SSE2)
+    const __m128i zeroBytes = _mm_setzero_si128();
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 step = _mm_set1_ps(timeStep);
+    const __m128 scaleFactor = _mm_set1_ps(1.0f / SHRINK_TIME);
+    const __m128i hitBit = _mm_set1_epi8(BRICK_HIT);
+    const __m128i shrinkingBit = _mm_set1_epi8(BRICK_SHRINKING);
+    const __m128i collapsedBit = _mm_set1_epi8(BRICK_COLLAPSED);
+    const __m128i hitOrCollapsed = _mm_set1_epi8(BRICK_HIT | BRICK_COLLAPSED);
+    float scales[16];
+    for (; i + 16 <= end; i += 16)
+    {
+        // intact bricks have zero flags and zero timers, whole block of them needs no work
+        __m128i flags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(flags_ + i));
+        if (0xffff == _mm_movemask_epi8(_mm_cmpeq_epi8(flags, zeroBytes)))
+        {
+            state.remaining_ += 16;
+            continue;
+        }
+        __m128i timedOut[4];
+        for (unsigned j = 0; j < 4; j ++)
+        {
+            __m128 shrinkTime = _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(shrinkTime_ + i + j * 4), step), zero);
+            _mm_storeu_ps(shrinkTime_ + i + j * 4, shrinkTime);
+            _mm_storeu_ps(scales + j * 4, _mm_mul_ps(shrinkTime, scaleFactor));
+            timedOut[j] = _mm_castps_si128(_mm_cmple_ps(shrinkTime, zero));
+        }
+        __m128i timedOutBytes = _mm_packs_epi16(_mm_packs_epi32(timedOut[0], timedOut[1]),
+                                                _mm_packs_epi32(timedOut[2], timedOut[3]));
+        __m128i hit = _mm_cmpeq_epi8(_mm_and_si128(flags, hitBit), hitBit);
+        __m128i shrinking = _mm_cmpeq_epi8(_mm_and_si128(flags, shrinkingBit), shrinkingBit);
+        __m128i collapse = _mm_and_si128(shrinking, timedOutBytes);
+        __m128i newFlags = _mm_or_si128(_mm_and_si128(collapse, collapsedBit), _mm_andnot_si128(collapse, flags));
+        __m128i remaining = _mm_cmpeq_epi8(_mm_and_si128(newFlags, hitOrCollapsed), zeroBytes);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(flags_ + i), _mm_andnot_si128(hitBit, newFlags));
+        BlockMasks masks =
+        {
+            unsigned(_mm_movemask_epi8(hit)),
+            unsigned(_mm_movemask_epi8(shrinking)),
+            unsigned(_mm_movemask_epi8(collapse)),
+            unsigned(_mm_movemask_epi8(remaining))
+        };
+        emitBlock(i, masks, scales, state);
+    }
+#elif defined(BRICK_KERNEL_NEON)
+    const float32x4_t zero = vdupq_n_f32(0);
+    const float32x4_t step = vdupq_n_f32(timeStep);
+    const float32x4_t scaleFactor = vdupq_n_f32(1.0f / SHRINK_TIME);
+    const uint8x16_t zeroBytes = vdupq_n_u8(0);
+    const uint8x16_t hitBit = vdupq_n_u8(BRICK_HIT);
+    const uint8x16_t shrinkingBit = vdupq_n_u8(BRICK_SHRINKING);
+    const uint8x16_t collapsedBit = vdupq_n_u8(BRICK_COLLAPSED);
+    const uint8x16_t hitOrCollapsed = vdupq_n_u8(BRICK_HIT | BRICK_COLLAPSED);
+    float scales[16];
+    for (; i + 16 <= end; i += 16)
+    {
+        // intact bricks have zero flags and zero timers, whole block of them needs no work
+        uint8x16_t flags = vld1q_u8(flags_ + i);
+        uint64x2_t flagWords = vreinterpretq_u64_u8(flags);
+        if (0 == (vgetq_lane_u64(flagWords, 0) | vgetq_lane_u64(flagWords, 1)))
+        {
+            state.remaining_ += 16;
+            continue;
+        }
+        uint16x4_t timedOut[4];
+        for (unsigned j = 0; j < 4; j ++)
+        {
+            float32x4_t shrinkTime = vmaxq_f32(vsubq_f32(vld1q_f32(shrinkTime_ + i + j * 4), step), zero);
+            vst1q_f32(shrinkTime_ + i + j * 4, shrinkTime);
+            vst1q_f32(scales + j * 4, vmulq_f32(shrinkTime, scaleFactor));
+            timedOut[j] = vmovn_u32(vcleq_f32(shrinkTime, zero));
+        }
+        uint8x16_t timedOutBytes = vcombine_u8(vmovn_u16(vcombine_u16(timedOut[0], timedOut[1])),
+                                               vmovn_u16(vcombine_u16(timedOut[2], timedOut[3])));
+        uint8x16_t hit = vtstq_u8(flags, hitBit);
+        uint8x16_t shrinking = vtstq_u8(flags, shrinkingBit);
+        uint8x16_t collapse = vandq_u8(shrinking, timedOutBytes);
+        uint8x16_t newFlags = vbslq_u8(collapse, collapsedBit, flags);
+        uint8x16_t remaining = vceqq_u8(vandq_u8(newFlags, hitOrCollapsed), zeroBytes);
+        vst1q_u8(flags_ + i, vbicq_u8(newFlags, hitBit));
+        BlockMasks masks = { byteBits(hit), byteBits(shrinking), byteBits(collapse), byteBits(remaining) };
+        emitBlock(i, masks, scales, state);
+    }
+#endif
+    // scalar tail
+    for (; i < end; i ++)
+    {
+        float shrinkTime = shrinkTime_[i] - timeStep;
+        shrinkTime_[i] = shrinkTime > 0 ? shrinkTime : 0;
+        processBrick(i, state);
+    }
+}
@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "handletable.h"
+
+const int BRICK_SCORES = 10;
+const float SHRINK_TIME = 0.5f;
+
+/// Brick state flags.
+enum BrickFlag
+{
+    /// Brick was hit, its score and bonus are not collected yet.
+    BRICK_HIT = 1,
+    /// Brick shrinks after hit.
+    BRICK_SHRINKING = 2,
+    /// Brick has shrunk completely and should be removed.
+    BRICK_COLLAPSED = 4
+};
+
+/// Results of BrickStore::Update(). Arrays point to buffers owned by the store and are valid until next update.
+struct BrickUpdateResult
+{
+    /// Scores of bricks hit since previous update.
+    unsigned scores_;
+    /// Bonuses of bricks hit since previous update.
+    const EntityHandle* releasedBonuses_;
+    unsigned releasedCount_;
+    /// Slots and new scales of bricks whose scale has changed.
+    const unsigned* scaledSlots_;
+    const float* scales_;
+    unsigned scaledCount_;
+    /// Bricks which have collapsed and should be removed.
+    const EntityHandle* collapsed_;
+    unsigned collapsedCount_;
+    /// Number of bricks which were not hit since previous update and have not collapsed.
+    unsigned remaining_;
+};
+
+/// Results of BrickStore::UpdateRange(), kept in result buffers of the store from the range begin on.
+struct BrickRangeResult
+{
+    unsigned begin_;
+    unsigned hitCount_;
+    unsigned releasedCount_;
+    unsigned scaledCount_;
+    unsigned collapsedCount_;
+    unsigned remaining_;
+};
+
+/// Packed structure-of-arrays gameplay state of level bricks. Each column is a separate array indexed by dense index,
+/// so per-frame processing runs as tight loops over few arrays. Storage comes from level arena.
+class BrickStore
+{
+public:
+    BrickStore();
+
+    /// Set up storage for up to capacity bricks.
+    void Initialize(LevelArena& arena, unsigned capacity);
+    /// Forget all bricks, storage is released by the arena.
+    void Clear();
+    /// Add intact brick.
+    EntityHandle Add(float x, float y, unsigned char kind, EntityHandle bonus);
+    /// Remove brick. Return false for stale handle.
+    bool Remove(EntityHandle handle);
+    /// Register ball hit, starts collapse of intact brick.
+    void Hit(EntityHandle handle);
+    /// Collect scores and bonuses of hit bricks, advance shrink animation and find collapsed bricks in one pass.
+    /// With AVX2, SSE2 or NEON timers, scales, collapse test and new flags of every block of bricks are computed in
+    /// vector registers and intact blocks are skipped, only compaction of result arrays runs per changed brick.
+    void Update(float timeStep, BrickUpdateResult& result);
+    /// Same as Update() for dense index range [begin, end). Disjoint ranges may be updated in parallel, every range
+    /// writes its results into its own part of result buffers.
+    void UpdateRange(float timeStep, unsigned begin, unsigned end, BrickRangeResult& range);
+    /// Pack results of consecutive ranges covering all bricks in range order, same as results of Update().
+    void MergeRanges(const BrickRangeResult* ranges, unsigned count, BrickUpdateResult& result);
+    /// Same as Update() without SIMD, reference for the vectorized kernel.
+    void UpdateScalar(float timeStep, BrickUpdateResult& result);
+    /// Return name of instruction set used by Update().
+    static const char* GetKernelName();
+
+    /// Return whether handle refers to a brick of the store.
+    bool IsValid(EntityHandle handle) const { return map_.IsValid(handle); }
+    /// Return whether brick has shrunk completely.
+    bool IsCollapsed(EntityHandle handle) const { return map_.IsValid(handle) && 0 != (flags_[map_.GetIndex(handle)] & BRICK_COLLAPSED); }
+    /// Return number of bricks.
+    unsigned Size() const { return map_.Size(); }
+    /// Return slot of brick by dense index, slot is stable during brick lifetime.
+    unsigned GetSlot(unsigned index) const { return map_.GetSlot(index); }
+    /// Return handle of brick by dense index.
+    EntityHandle GetHandle(unsigned index) const { return map_.GetHandle(index); }
+    /// Return columns, indexed by dense index.
+    const float* GetX() const { return x_; }
+    const float* GetY() const { return y_; }
+    const unsigned char* GetKinds() const { return kind_; }
+    const EntityHandle* GetBonuses() const { return bonus_; }
+    const float* GetShrinkTimes() const { return shrinkTime_; }
+    const unsigned char* GetFlags() const { return flags_; }
+
+private:
+    BrickStore(const BrickStore&);
+    BrickStore& operator =(const BrickStore&);
+
+    /// Per-pass counters of the kernel.
+    struct PassState
+    {
+        unsigned hitCount_;
+        unsigned releasedCount_;
+        unsigned scaledCount_;
+        unsigned collapsedCount_;
+        unsigned remaining_;
+    };
+    /// Lane masks of a block of bricks computed by vector kernel, bit per brick.
+    struct BlockMasks
+    {
+        unsigned hit_;
+        unsigned shrinking_;
+        unsigned collapsed_;
+        unsigned remaining_;
+    };
+    /// Emit events of brick whose shrink timer is already advanced.
+    inline void processBrick(unsigned index, PassState& state);
+    /// Append events of block of bricks starting at dense index from its lane masks and scales.
+    inline void emitBlock(unsigned first, const BlockMasks& masks, const float* scales, PassState& state);
+    /// Run kernel over dense index range, results are written at positions of state counters.
+    void updatePass(float timeStep, unsigned begin, unsigned end, PassState& state);
+    /// Fill result from pass counters.
+    void finishPass(const PassState& state, BrickUpdateResult& result);
+
+    HandleMap map_;
+    float* x_;
+    float* y_;
+    unsigned char* kind_;
+    EntityHandle* bonus_;
+    float* shrinkTime_;
+    unsigned char* flags_;
+    // update result buffers
+    EntityHandle* releasedBonuses_;
+    unsigned* scaledSlots_;
+    float* scales_;
+    EntityHandle* collapsed_;
+};
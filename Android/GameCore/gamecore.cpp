@@ -0,0 +1,650 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "gamecore.h"
+
+namespace
+{
+// minimum vertical speed part of the ball, see ClampBallVelocity()
+const float BALL_MIN_VERTICAL = 0.05f;
+// smaller levels are updated on calling thread, job overhead would outweigh the work
+const unsigned PARALLEL_MIN_BRICKS = 1024;
+const unsigned PARALLEL_MIN_BONUSES = 256;
+// work of one job
+const unsigned ROWS_PER_JOB = 4;
+const unsigned BONUSES_PER_JOB = 64;
+
+float clampValue(float value, float min, float max)
+{
+    return value < min ? min : (value > max ? max : value);
+}
+
+// moves value towards target by at most delta
+float approach(float value, float target, float delta)
+{
+    float diff = target - value;
+    if (delta >= std::fabs(diff))
+    {
+        return target;
+    }
+    return diff > 0 ? value + delta : value - delta;
+}
+}
+
+GameConfig::GameConfig() :
+    brickWidth_(0.2f),
+    brickHeight_(0.1f),
+    paddleHalfWidth_(0.15f),
+    paddleHalfHeight_(0.03f),
+    paddleY_(-0.9f),
+    ballRadius_(0.03f),
+    ballOffsetY_(0.075f),
+    bonusHalfWidth_(0.05f),
+    bonusHalfHeight_(0.025f)
+{
+}
+
+GameCore::GameCore() :
+    randomState_(1),
+    cells_(nullptr),
+    brickCells_(nullptr),
+    activatedBonuses_(nullptr),
+    removedBonuses_(nullptr),
+    activeBonuses_(nullptr),
+    activeBonusCount_(0),
+    jobRunner_(nullptr),
+    brickRanges_(nullptr),
+    jobRangeSize_(0),
+    jobTimeStep_(0),
+    scores_(0),
+    level_(0)
+{
+    layout_.countX_ = layout_.countY_ = 0;
+    layout_.brickWidth_ = layout_.brickHeight_ = 0;
+    layout_.shiftX_ = layout_.shiftY_ = 0;
+    paddle_.x_ = paddle_.targetX_ = 0;
+    paddle_.scaleLevel_ = 1;
+    paddle_.scale_ = GetPaddleScale(1);
+    ball_.x_ = ball_.y_ = 0;
+    ball_.velocityX_ = ball_.velocityY_ = 0;
+    ball_.onPaddle_ = true;
+    ClearEvents();
+}
+
+void GameCore::NewGame(unsigned seed)
+{
+    randomState_ = seed;
+    scores_ = 0;
+    level_ = 0;
+    paddle_.x_ = paddle_.targetX_ = 0;
+    PrepareLevel();
+    ClearEvents();
+}
+
+void GameCore::PrepareLevel()
+{
+    // all per-level data is released at once
+    bricks_.Clear();
+    bonuses_.Clear();
+    cells_ = nullptr;
+    brickCells_ = nullptr;
+    activatedBonuses_ = removedBonuses_ = nullptr;
+    activeBonuses_ = nullptr;
+    activeBonusCount_ = 0;
+    brickRanges_ = nullptr;
+    arena_.Reset();
+    events_.scaledBrickCount_ = events_.collapsedBrickCount_ = 0;
+    events_.activatedBonusCount_ = events_.removedBonusCount_ = 0;
+    level_ ++;
+
+    float width = config_.brickWidth_;
+    float height = config_.brickHeight_;
+    layout_.countX_ = layout_.countY_ = 0;
+    if (width > 0
+        && height > 0)
+    {
+        layout_.countX_ = int(FIELD_WIDTH / width);
+        layout_.countY_ = int(FIELD_HEIGHT / height) * 11 / 16;
+        layout_.brickWidth_ = width;
+        layout_.brickHeight_ = height;
+        layout_.shiftX_ = 0.5f * width * (layout_.countX_ - 1);
+        layout_.shiftY_ = 0.5f * height * (int(FIELD_HEIGHT / height) - 1);
+    }
+    unsigned maxCount = unsigned(layout_.countX_ * layout_.countY_);
+    bricks_.Initialize(arena_, maxCount);
+    bonuses_.Initialize(arena_, maxCount);
+    cells_ = arena_.AllocateArray<EntityHandle>(maxCount);
+    brickCells_ = arena_.AllocateArray<unsigned>(maxCount);
+    activatedBonuses_ = arena_.AllocateArray<EntityHandle>(maxCount);
+    removedBonuses_ = arena_.AllocateArray<EntityHandle>(maxCount);
+    activeBonuses_ = arena_.AllocateArray<unsigned>(maxCount);
+    // one range per job of ROWS_PER_JOB rows at most
+    brickRanges_ = arena_.AllocateArray<BrickRangeResult>(unsigned(layout_.countY_) / ROWS_PER_JOB + 1);
+    // level can't run without its tables and there are no exceptions to report it with, the same as out of memory
+    // in operator new
+    if (false != arena_.HasFailed())
+    {
+        abort();
+    }
+    events_.activatedBonuses_ = activatedBonuses_;
+    events_.removedBonuses_ = removedBonuses_;
+    for (int j = 0; j < layout_.countY_; j ++)
+    {
+        for (int i = 0; i < layout_.countX_; i ++)
+        {
+            float x = layout_.shiftX_ - i * width;
+            float y = layout_.shiftY_ - j * height;
+            int kind = random(0, 4);
+            int bonusType = random(BONUS_NONE, BONUS_COUNT);
+            EntityHandle bonusHandle = NULL_HANDLE;
+            if (BONUS_NONE != bonusType)
+            {
+                BonusState bonus;
+                bonus.x_ = x;
+                bonus.y_ = y;
+                bonus.type_ = (unsigned char)bonusType;
+                bonus.active_ = false;
+                bonus.slowed_ = false;
+                bonusHandle = bonuses_.Add(bonus);
+            }
+            unsigned cell = unsigned(j * layout_.countX_ + i);
+            EntityHandle brickHandle = bricks_.Add(x, y, (unsigned char)kind, bonusHandle);
+            cells_[cell] = brickHandle;
+            brickCells_[brickHandle.slot_] = cell;
+        }
+    }
+
+    // new level starts with ball on paddle of normal size
+    paddle_.scaleLevel_ = 1;
+    paddle_.scale_ = GetPaddleScale(1);
+    ball_.onPaddle_ = true;
+    ball_.velocityX_ = ball_.velocityY_ = 0;
+    ball_.x_ = paddle_.x_;
+    ball_.y_ = config_.paddleY_ + config_.ballOffsetY_;
+}
+
+void GameCore::Step(float timeStep, const GameInput& input)
+{
+    ClearEvents();
+    if (false != input.movePaddle_)
+    {
+        SetPaddleTarget(input.paddleTargetX_);
+    }
+    if (false != input.launch_)
+    {
+        LaunchBall();
+    }
+    if (false == ball_.onPaddle_)
+    {
+        moveBall(timeStep, SPEED_NORMAL * input.speed_);
+    }
+    MoveBonuses(timeStep);
+    if (false == ball_.onPaddle_
+        && false != IsBallOut(ball_.y_))
+    {
+        LoseBall();
+    }
+    Update(timeStep);
+    // resting ball follows paddle
+    if (false != ball_.onPaddle_)
+    {
+        ball_.x_ = paddle_.x_;
+        ball_.y_ = config_.paddleY_ + config_.ballOffsetY_;
+    }
+}
+
+void GameCore::Update(float timeStep)
+{
+    updatePaddle(timeStep);
+    // collect scores of hit bricks, shrink collapsing bricks, find out if there are no more bricks
+    BrickUpdateResult bricksResult;
+    updateBricks(timeStep, bricksResult);
+    scores_ += bricksResult.scores_;
+    // start bonuses of hit bricks, unless they were removed
+    for (unsigned i = 0; i < bricksResult.releasedCount_; i ++)
+    {
+        EntityHandle bonusHandle = bricksResult.releasedBonuses_[i];
+        BonusState* bonus = bonuses_.Get(bonusHandle);
+        if (nullptr != bonus
+            && false == bonus->active_)
+        {
+            bonus->active_ = true;
+            activatedBonuses_[events_.activatedBonusCount_ ++] = bonusHandle;
+        }
+    }
+    events_.scaledBrickSlots_ = bricksResult.scaledSlots_;
+    events_.brickScales_ = bricksResult.scales_;
+    events_.scaledBrickCount_ = bricksResult.scaledCount_;
+    // remove collapsed bricks, slots stay readable in events
+    for (unsigned i = 0; i < bricksResult.collapsedCount_; i ++)
+    {
+        EntityHandle brickHandle = bricksResult.collapsed_[i];
+        cells_[brickCells_[brickHandle.slot_]] = NULL_HANDLE;
+        bricks_.Remove(brickHandle);
+    }
+    events_.collapsedBricks_ = bricksResult.collapsed_;
+    events_.collapsedBrickCount_ = bricksResult.collapsedCount_;
+    // if there are no more intact bricks create next level
+    if (0 == bricksResult.remaining_)
+    {
+        PrepareLevel();
+        events_.levelCompleted_ = true;
+    }
+}
+
+void GameCore::ClearEvents()
+{
+    events_.scaledBrickSlots_ = nullptr;
+    events_.brickScales_ = nullptr;
+    events_.scaledBrickCount_ = 0;
+    events_.collapsedBricks_ = nullptr;
+    events_.collapsedBrickCount_ = 0;
+    events_.activatedBonuses_ = activatedBonuses_;
+    events_.activatedBonusCount_ = 0;
+    events_.removedBonuses_ = removedBonuses_;
+    events_.removedBonusCount_ = 0;
+    events_.ballHits_ = 0;
+    events_.ballLost_ = false;
+    events_.levelCompleted_ = false;
+}
+
+void GameCore::LaunchBall()
+{
+    if (false != ball_.onPaddle_)
+    {
+        ball_.onPaddle_ = false;
+        ball_.velocityX_ = 0;
+        ball_.velocityY_ = SPEED_NORMAL;
+    }
+}
+
+void GameCore::CatchBonus(EntityHandle bonusHandle)
+{
+    BonusState* bonus = bonuses_.Get(bonusHandle);
+    // bonuses still inside bricks can't be caught
+    if (nullptr == bonus
+        || false == bonus->active_)
+    {
+        return;
+    }
+    switch (bonus->type_)
+    {
+        case BONUS_SHRINKPADDLE:
+            if (paddle_.scaleLevel_ > 0)
+            {
+                paddle_.scaleLevel_ --;
+            }
+            break;
+        case BONUS_EXTENDPADDLE:
+            if (paddle_.scaleLevel_ < PADDLE_SCALE_MAX)
+            {
+                paddle_.scaleLevel_ ++;
+            }
+            break;
+        default:
+            scores_ += BONUS_SCORES[bonus->type_];
+            break;
+    }
+    removeBonus(bonusHandle);
+}
+
+float GameCore::takeBonusSpeed(EntityHandle bonusHandle)
+{
+    BonusState* bonus = bonuses_.Get(bonusHandle);
+    if (nullptr == bonus)
+    {
+        return 0;
+    }
+    float speed = false != bonus->slowed_ ? 0.5f * BONUS_SPEED : BONUS_SPEED;
+    bonus->slowed_ = false;
+    return speed;
+}
+
+void GameCore::SetBall(float x, float y, float velocityX, float velocityY)
+{
+    ball_.x_ = x;
+    ball_.y_ = y;
+    ball_.velocityX_ = velocityX;
+    ball_.velocityY_ = velocityY;
+}
+
+void GameCore::DropBonus(EntityHandle bonusHandle)
+{
+    removeBonus(bonusHandle);
+}
+
+void GameCore::LoseBall()
+{
+    ball_.onPaddle_ = true;
+    ball_.velocityX_ = ball_.velocityY_ = 0;
+    ball_.x_ = paddle_.x_;
+    ball_.y_ = config_.paddleY_ + config_.ballOffsetY_;
+    paddle_.scaleLevel_ = 1;
+    paddle_.scale_ = GetPaddleScale(1);
+    // iterate backwards, removal moves last bonus into freed place
+    for (unsigned i = bonuses_.Size(); i -- > 0;)
+    {
+        if (false != bonuses_[i].active_)
+        {
+            removeBonus(bonuses_.GetHandle(i));
+        }
+    }
+    events_.ballLost_ = true;
+}
+
+void GameCore::ClampBallVelocity(float& velocityX, float& velocityY, float speed)
+{
+    float vertical = velocityY < 0 ? -velocityY : velocityY;
+    if (vertical < BALL_MIN_VERTICAL)
+    {
+        vertical = BALL_MIN_VERTICAL;
+    }
+    velocityY = velocityY < 0 ? -vertical : vertical;
+    float length = std::sqrt(velocityX * velocityX + velocityY * velocityY);
+    velocityX *= speed / length;
+    velocityY *= speed / length;
+}
+
+int GameCore::random(int min, int max)
+{
+    randomState_ = randomState_ * 1103515245u + 12345u;
+    return min + int((randomState_ >> 16) % unsigned(max - min));
+}
+
+void GameCore::updatePaddle(float timeStep)
+{
+    float halfWidth = config_.paddleHalfWidth_ * paddle_.scale_;
+    paddle_.targetX_ = clampValue(paddle_.targetX_, -0.5f * FIELD_WIDTH + halfWidth, 0.5f * FIELD_WIDTH - halfWidth);
+    paddle_.x_ = approach(paddle_.x_, paddle_.targetX_, timeStep * PADDLE_SPEED);
+    paddle_.scale_ = approach(paddle_.scale_, GetPaddleScale(paddle_.scaleLevel_), timeStep * PADDLE_SCALE_SPEED);
+}
+
+void GameCore::moveBall(float timeStep, float speed)
+{
+    float radius = config_.ballRadius_;
+    // substeps keep ball from tunnelling through bricks
+    float distance = speed * timeStep;
+    int substeps = 1 + int(distance / (0.5f * radius));
+    float dt = timeStep / substeps;
+    float halfWidth = config_.paddleHalfWidth_ * paddle_.scale_;
+    for (int step = 0; step < substeps; step ++)
+    {
+        ball_.x_ += ball_.velocityX_ * dt;
+        ball_.y_ += ball_.velocityY_ * dt;
+        // field borders, bottom is open
+        if (ball_.x_ - radius < -0.5f * FIELD_WIDTH)
+        {
+            ball_.x_ = -0.5f * FIELD_WIDTH + radius;
+            ball_.velocityX_ = std::fabs(ball_.velocityX_);
+        }
+        else if (ball_.x_ + radius > 0.5f * FIELD_WIDTH)
+        {
+            ball_.x_ = 0.5f * FIELD_WIDTH - radius;
+            ball_.velocityX_ = -std::fabs(ball_.velocityX_);
+        }
+        if (ball_.y_ + radius > 0.5f * FIELD_HEIGHT)
+        {
+            ball_.y_ = 0.5f * FIELD_HEIGHT - radius;
+            ball_.velocityY_ = -std::fabs(ball_.velocityY_);
+        }
+        // bricks, only cells around the ball are tested and the first touched brick bounces the ball
+        if (layout_.countX_ > 0)
+        {
+            int centerI = int(std::floor((layout_.shiftX_ - ball_.x_) / layout_.brickWidth_ + 0.5f));
+            int centerJ = int(std::floor((layout_.shiftY_ - ball_.y_) / layout_.brickHeight_ + 0.5f));
+            bool bounced = false;
+            for (int j = centerJ - 1; j <= centerJ + 1 && false == bounced; j ++)
+            {
+                for (int i = centerI - 1; i <= centerI + 1 && false == bounced; i ++)
+                {
+                    if (i < 0 || i >= layout_.countX_ || j < 0 || j >= layout_.countY_)
+                    {
+                        continue;
+                    }
+                    EntityHandle brickHandle = cells_[j * layout_.countX_ + i];
+                    if (false == bricks_.IsValid(brickHandle))
+                    {
+                        continue;
+                    }
+                    float brickX = layout_.shiftX_ - i * layout_.brickWidth_;
+                    float brickY = layout_.shiftY_ - j * layout_.brickHeight_;
+                    float dx = ball_.x_ - brickX;
+                    float dy = ball_.y_ - brickY;
+                    float overlapX = 0.5f * layout_.brickWidth_ + radius - std::fabs(dx);
+                    float overlapY = 0.5f * layout_.brickHeight_ + radius - std::fabs(dy);
+                    if (overlapX <= 0
+                        || overlapY <= 0)
+                    {
+                        continue;
+                    }
+                    // reflect along axis of smaller penetration
+                    if (overlapX < overlapY)
+                    {
+                        ball_.x_ += dx < 0 ? -overlapX : overlapX;
+                        ball_.velocityX_ = dx < 0 ? -std::fabs(ball_.velocityX_) : std::fabs(ball_.velocityX_);
+                    }
+                    else
+                    {
+                        ball_.y_ += dy < 0 ? -overlapY : overlapY;
+                        ball_.velocityY_ = dy < 0 ? -std::fabs(ball_.velocityY_) : std::fabs(ball_.velocityY_);
+                    }
+                    HitBrick(brickHandle);
+                    events_.ballHits_ ++;
+                    bounced = true;
+                }
+            }
+        }
+        // paddle bounces falling ball, hit position defines new direction
+        float dx = ball_.x_ - paddle_.x_;
+        float dy = ball_.y_ - config_.paddleY_;
+        if (ball_.velocityY_ < 0
+            && std::fabs(dx) < halfWidth + radius
+            && std::fabs(dy) < config_.paddleHalfHeight_ + radius)
+        {
+            ball_.y_ = config_.paddleY_ + config_.paddleHalfHeight_ + radius;
+            ball_.velocityX_ = PADDLE_DEFLECTION * speed * clampValue(dx / halfWidth, -1, 1);
+            ball_.velocityY_ = std::fabs(ball_.velocityY_);
+            events_.ballHits_ ++;
+        }
+    }
+    ClampBallVelocity(ball_.velocityX_, ball_.velocityY_, speed);
+}
+
+void GameCore::updateBricks(float timeStep, BrickUpdateResult& result)
+{
+    unsigned count = bricks_.Size();
+    if (nullptr == jobRunner_
+        || count < PARALLEL_MIN_BRICKS)
+    {
+        bricks_.Update(timeStep, result);
+        return;
+    }
+    // dense order of bricks starts in grid row order, so ranges of whole rows cover neighbouring bricks mostly;
+    // merged results are the same as of single pass
+    unsigned rangeSize = ROWS_PER_JOB * unsigned(layout_.countX_);
+    jobTimeStep_ = timeStep;
+    runRanges(count, rangeSize, updateBricksJob);
+    bricks_.MergeRanges(brickRanges_, (count + rangeSize - 1) / rangeSize, result);
+}
+
+void GameCore::fallBonuses(float timeStep, unsigned begin, unsigned end)
+{
+    for (unsigned i = begin; i < end; i ++)
+    {
+        if (false != bonuses_[i].active_)
+        {
+            bonuses_[i].y_ -= takeBonusSpeed(bonuses_.GetHandle(i)) * timeStep;
+        }
+    }
+}
+
+void GameCore::sortActiveBonuses()
+{
+    // bonuses still inside bricks can't stack, they are left out of the list
+    activeBonusCount_ = 0;
+    for (unsigned i = 0; i < bonuses_.Size(); i ++)
+    {
+        if (false != bonuses_[i].active_)
+        {
+            activeBonuses_[activeBonusCount_ ++] = i;
+        }
+    }
+    const HandleTable<BonusState>& bonuses = bonuses_;
+    std::sort(activeBonuses_, activeBonuses_ + activeBonusCount_, [&bonuses](unsigned a, unsigned b)
+    {
+        return bonuses[a].x_ < bonuses[b].x_;
+    });
+}
+
+void GameCore::stackBonuses(unsigned begin, unsigned end)
+{
+    // bonus lying on top of another one falls slower during next step, only neighbours in sorted list closer than
+    // bonus width in x can be under it
+    float reachX = 2 * config_.bonusHalfWidth_;
+    float reachY = 2 * config_.bonusHalfHeight_;
+    for (unsigned i = begin; i < end; i ++)
+    {
+        BonusState& upper = bonuses_[activeBonuses_[i]];
+        for (unsigned j = i; j -- > 0 && false == upper.slowed_;)
+        {
+            const BonusState& lower = bonuses_[activeBonuses_[j]];
+            if (upper.x_ - lower.x_ >= reachX)
+            {
+                break;
+            }
+            if (upper.y_ > lower.y_
+                && upper.y_ - lower.y_ < reachY)
+            {
+                upper.slowed_ = true;
+            }
+        }
+        for (unsigned j = i + 1; j < activeBonusCount_ && false == upper.slowed_; j ++)
+        {
+            const BonusState& lower = bonuses_[activeBonuses_[j]];
+            if (lower.x_ - upper.x_ >= reachX)
+            {
+                break;
+            }
+            if (upper.y_ > lower.y_
+                && upper.y_ - lower.y_ < reachY)
+            {
+                upper.slowed_ = true;
+            }
+        }
+    }
+}
+
+void GameCore::runRanges(unsigned count, unsigned rangeSize, void (*job)(void* data, unsigned index))
+{
+    jobRangeSize_ = rangeSize;
+    unsigned jobs = (count + rangeSize - 1) / rangeSize;
+    if (nullptr != jobRunner_)
+    {
+        jobRunner_->Run(jobs, job, this);
+        return;
+    }
+    for (unsigned i = 0; i < jobs; i ++)
+    {
+        job(this, i);
+    }
+}
+
+void GameCore::updateBricksJob(void* data, unsigned index)
+{
+    GameCore* core = static_cast<GameCore*>(data);
+    unsigned begin = index * core->jobRangeSize_;
+    unsigned end = begin + core->jobRangeSize_;
+    core->bricks_.UpdateRange(core->jobTimeStep_, begin, end < core->bricks_.Size() ? end : core->bricks_.Size(),
+                              core->brickRanges_[index]);
+}
+
+void GameCore::fallBonusesJob(void* data, unsigned index)
+{
+    GameCore* core = static_cast<GameCore*>(data);
+    unsigned begin = index * core->jobRangeSize_;
+    unsigned end = begin + core->jobRangeSize_;
+    core->fallBonuses(core->jobTimeStep_, begin, end < core->bonuses_.Size() ? end : core->bonuses_.Size());
+}
+
+void GameCore::stackBonusesJob(void* data, unsigned index)
+{
+    GameCore* core = static_cast<GameCore*>(data);
+    unsigned begin = index * core->jobRangeSize_;
+    unsigned end = begin + core->jobRangeSize_;
+    core->stackBonuses(begin, end < core->activeBonusCount_ ? end : core->activeBonusCount_);
+}
+
+void GameCore::MoveBonuses(float timeStep)
+{
+    float halfWidth = config_.paddleHalfWidth_ * paddle_.scale_;
+    float reachX = halfWidth + config_.bonusHalfWidth_;
+    float reachY = config_.paddleHalfHeight_ + config_.bonusHalfHeight_;
+    // every bonus is moved and checked on its own, stacking check needs all bonuses moved and sorted first
+    if (bonuses_.Size() >= PARALLEL_MIN_BONUSES)
+    {
+        jobTimeStep_ = timeStep;
+        runRanges(bonuses_.Size(), BONUSES_PER_JOB, fallBonusesJob);
+    }
+    else
+    {
+        fallBonuses(timeStep, 0, bonuses_.Size());
+    }
+    sortActiveBonuses();
+    if (activeBonusCount_ >= PARALLEL_MIN_BONUSES)
+    {
+        runRanges(activeBonusCount_, BONUSES_PER_JOB, stackBonusesJob);
+    }
+    else
+    {
+        stackBonuses(0, activeBonusCount_);
+    }
+    // iterate backwards, removal moves last bonus into freed place
+    for (unsigned i = bonuses_.Size(); i -- > 0;)
+    {
+        const BonusState& bonus = bonuses_[i];
+        if (false == bonus.active_)
+        {
+            continue;
+        }
+        if (std::fabs(bonus.x_ - paddle_.x_) < reachX
+            && std::fabs(bonus.y_ - config_.paddleY_) < reachY)
+        {
+            CatchBonus(bonuses_.GetHandle(i));
+        }
+        else if (false != IsBonusOut(bonus.y_))
+        {
+            DropBonus(bonuses_.GetHandle(i));
+        }
+    }
+}
+
+void GameCore::removeBonus(EntityHandle bonusHandle)
+{
+    if (false != bonuses_.Remove(bonusHandle))
+    {
+        removedBonuses_[events_.removedBonusCount_ ++] = bonusHandle;
+    }
+}
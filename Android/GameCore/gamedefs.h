@@ -0,0 +1,42 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+enum { BONUS_NONE, BONUS_SHRINKPADDLE, BONUS_EXTENDPADDLE,
+        BONUS_100, BONUS_200, BONUS_500,
+        BONUS_1000, BONUS_2000, BONUS_5000, BONUS_10000, BONUS_COUNT };
+
+/// Scores of caught bonus by bonus type.
+const unsigned BONUS_SCORES[BONUS_COUNT] = { 0, 0, 0, 100, 200, 500, 1000, 2000, 5000, 10000 };
+const float BONUS_SPEED = 0.2f;
+const float FIELD_WIDTH = 2;
+const float FIELD_HEIGHT = 2;
+
+const float PADDLE_SPEED = 10.f;
+const float PADDLE_SCALE_SPEED = 1.f;
+const int PADDLE_SCALE_MAX = 4;
+/// Horizontal speed part of the ball leaving paddle edge in GameCore::Step().
+const float PADDLE_DEFLECTION = 0.75f;
+
+const float SPEED_NORMAL = 1;
+const float SPEED_TURBO = 2;
@@ -0,0 +1,83 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/// Linear allocator for per-level game data. Memory is handed out from large blocks and released all at once by Reset(),
+/// blocks are kept for next levels, so after the first level building a level of the same size doesn't touch heap.
+/// Destructors are not called, only trivially destructible types should be allocated here.
+class LevelArena
+{
+public:
+    explicit LevelArena(size_t blockSize = 64 * 1024);
+    ~LevelArena();
+
+    /// Allocate aligned memory, valid until Reset(). Return null when heap is exhausted.
+    void* Allocate(size_t size, size_t alignment);
+    /// Allocate array of default constructed objects. Return null when heap is exhausted.
+    template <class T> T* AllocateArray(unsigned count)
+    {
+        T* result = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        if (nullptr == result)
+        {
+            return nullptr;
+        }
+        for (unsigned i = 0; i < count; i ++)
+        {
+            new (result + i) T();
+        }
+        return result;
+    }
+    /// Release everything allocated since previous reset. Constant time, blocks are kept.
+    void Reset();
+    /// Return whether an allocation failed since previous reset.
+    bool HasFailed() const { return failed_; }
+    /// Return bytes handed out since previous reset (including alignment padding).
+    size_t GetUsed() const;
+    /// Return total size of owned blocks.
+    size_t GetCapacity() const { return capacity_; }
+
+private:
+    struct Block
+    {
+        Block* next_;
+        size_t size_;
+    };
+
+    LevelArena(const LevelArena&);
+    LevelArena& operator =(const LevelArena&);
+
+    /// Return first usable byte of block.
+    static char* getData(Block* block) { return reinterpret_cast<char*>(block) + sizeof(Block); }
+
+    size_t blockSize_;
+    size_t capacity_;
+    Block* first_;
+    Block* current_;
+    size_t offset_;
+    /// Bytes used in blocks preceding current_.
+    size_t usedBefore_;
+    bool failed_;
+};
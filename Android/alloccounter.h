@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+/// Subsystems heap allocations are attributed to. Scopes are per thread: ALLOC_SCOPE_AUDIO only covers audio code on
+/// main thread (sound playback calls), the audio mixer runs on its own thread created by SDL, which is never marked, so
+/// its allocations are counted as ALLOC_SCOPE_WORKER like those of work queue threads.
+enum AllocScope { ALLOC_SCOPE_ENGINE, ALLOC_SCOPE_GAME, ALLOC_SCOPE_UI, ALLOC_SCOPE_AUDIO, ALLOC_SCOPE_WORKER, ALLOC_SCOPE_COUNT };
+
+/// Heap allocations made since the last AllocCounter::BeginFrame().
+struct AllocStats
+{
+    unsigned counts_[ALLOC_SCOPE_COUNT];
+    unsigned long long bytes_;
+
+    unsigned GetTotal() const
+    {
+        unsigned total = 0;
+        for (unsigned i = 0; i < ALLOC_SCOPE_COUNT; i ++)
+        {
+            total += counts_[i];
+        }
+        return total;
+    }
+};
+
+/// Counts heap allocations going through global operator new (Urho3D containers and allocator blocks use it too).
+/// Only compiled in with ARKANOID_ALLOC_COUNTER build option, otherwise all calls are no-ops.
+class AllocCounter
+{
+public:
+    /// Mark calling thread as main thread, allocations of other threads are attributed to ALLOC_SCOPE_WORKER.
+    static void SetMainThread();
+    /// Reset counters.
+    static void BeginFrame();
+    /// Return allocations made since last BeginFrame().
+    static void EndFrame(AllocStats& stats);
+    /// Return current scope of calling thread.
+    static AllocScope GetScope();
+    /// Set current scope of calling thread.
+    static void SetScope(AllocScope scope);
+};
+
+/// Attributes allocations of enclosing block to a scope and restores previous scope on exit.
+class AllocScopeGuard
+{
+public:
+    explicit AllocScopeGuard(AllocScope scope) : previous_(AllocCounter::GetScope()) { AllocCounter::SetScope(scope); }
+    ~AllocScopeGuard() { AllocCounter::SetScope(previous_); }
+private:
+    AllocScope previous_;
+};
+
+#ifdef ARKANOID_ALLOC_COUNTER
+#define ALLOC_SCOPE(scope) AllocScopeGuard allocScopeGuard_(scope)
+#else
+#define ALLOC_SCOPE(scope)
+#endif
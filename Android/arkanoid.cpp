@@ -20,12 +20,17 @@
 // THE SOFTWARE.
 //
 
-#include <string>
-#include <sstream>
+#include <cstdio>
+
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Graphics/GraphicsEvents.h>
+#include <Urho3D/Physics/PhysicsEvents.h>
+#include <Urho3D/Resource/JSONFile.h>
 
 #include "arkanoid.h"
 #include "ball.h"
 #include "brick.h"
+#include "brickfield.h"
 #include "paddle.h"
 #include "bonus.h"
 
@@ -33,31 +38,96 @@ using namespace Urho3D;
 
 const int BASE_WIDTH = 1280;
 const int BASE_HEIGHT = 720;
-const float SPEED_NORMAL = 1;
-const float SPEED_TURBO = 2;
+// time step of headless games, fixed so game result depends on its seed only
+const float SIMULATION_TIME_STEP = 1.0f / 60.0f;
+// names of benchmark scenarios in reports
+const char* BENCHMARK_NAMES[BENCHMARK_COUNT] = { "full_field", "falling_bonuses", "level_transition", "pause_resume" };
+// frames between level completions and pause toggles in benchmark scenarios
+const unsigned TRANSITION_INTERVAL = 120;
+const unsigned PAUSE_INTERVAL = 30;
+// frame rate of interactive game, and while it is paused or ball waits on paddle; quality governor changes the
+// former with quality tier
+const int ACTIVE_FPS = 40;
+const int IDLE_FPS = 10;
+// rate of game core steps on simulation thread
+const float SIMULATION_THREAD_STEP = 1.0f / 120.0f;
+// sky rotation in degrees per second, the same as angular velocity of sky body
+const float SKY_ROTATION_SPEED = 0.01f * M_RADTODEG;
+// initial quality tier, the one of 40 fps with shadows
+const unsigned DEFAULT_QUALITY_TIER = 1;
+// everything that moves stays within the field, only bonuses fall below it before they are removed; camera, light
+// and sky don't need octants
+const BoundingBox SCENE_BOUNDS(Vector3(-0.55f * FIELD_WIDTH, -0.8f * FIELD_HEIGHT, -0.25f * FIELD_WIDTH),
+                               Vector3(0.55f * FIELD_WIDTH, 0.55f * FIELD_HEIGHT, 0.25f * FIELD_WIDTH));
+// physics steps per second and substeps per frame, see PhysicsPacer
+const int PHYSICS_FPS = 60;
+const int PHYSICS_MAX_SUBSTEPS = 3;
+
+namespace
+{
+// returns command line value following option name, or default value
+String getOption(const Vector<String>& arguments, const char* name, const String& defaultValue)
+{
+    for (unsigned i = 0; i + 1 < arguments.Size(); i ++)
+    {
+        if (arguments[i] == name)
+        {
+            return arguments[i + 1];
+        }
+    }
+    return defaultValue;
+}
+
+// logs duration of startup phase and starts timing of the next one
+void logStartupPhase(const char* phase, HiresTimer& timer)
+{
+    URHO3D_LOGINFOF("Startup phase %s: %.2f ms", phase, timer.GetUSec(true) * 0.001f);
+}
+}
+
 // This happens before the engine has been initialized
 // so it's usually minimal code setting defaults for
 // whatever instance variables you have.
 // You can also do this in the Setup method.
 Arkanoid::Arkanoid(Context * context) : Application(context),
-                                            framecount_(0), time_(0), musicSource_(nullptr),
-                                            velocity_(SPEED_NORMAL), paused_(false), scores_(0)
+                                            framecount_(0), time_(0), musicSource_(nullptr), jobRunner_(context),
+                                            brickNodes_(nullptr), bonusNodes_(nullptr), nodeCapacity_(0),
+                                            velocity_(SPEED_NORMAL), paused_(false), levelReady_(false), levelChangePending_(false),
+                                            shownScores_(0),
+                                            autoplay_(false), headless_(false), simulate_(false), simulationDone_(false), seed_(0),
+                                            simThread_(false), shownLevel_(0),
+                                            maxLevels_(1), maxTime_(600), lostBalls_(0),
+                                            benchmark_(false), benchmarkScenario_(0), scenarioFrame_(0), scenarioFrames_(600),
+                                            startupTime_(0)
+#ifdef ARKANOID_ALLOC_COUNTER
+                                            , rallyFrames_(0), allocatingFrames_(0), allocCheck_(false), scenarioAllocs_(0)
+#endif
 {
 }
 
 void Arkanoid::handlePause(StringHash eventType, VariantMap& eventData)
+{
+    togglePause();
+}
+
+void Arkanoid::togglePause()
 {
     // everything (except paddle) moves due to physics, so disabling update will pause everything
     paused_ = !paused_;
-    physicsWorld_->SetUpdateEnabled(!paused_);
-    
+    physicsWorld_->SetUpdateEnabled(!paused_ && nullptr == simulation_.Get());
+    if (nullptr != simulation_.Get())
+    {
+        simulation_->SetPaused(paused_);
+    }
+    // music source stays at its position with its decoder, so resume costs nothing
+    Audio* audio = GetSubsystem<Audio>();
     if (false != paused_)
     {
-        musicSource_->Stop();
+        audio->PauseSoundType(SOUND_MUSIC);
     }
     else
     {
-        startMusic();
+        audio->ResumeSoundType(SOUND_MUSIC);
     }
 }
 
@@ -74,11 +144,13 @@ void Arkanoid::setupPhysicalProperties(RigidBody* rigidBody)
     rigidBody->SetUseGravity(false);
 }
 
-// common part of creating new scene node with model, collision shape and physics components
-Node* Arkanoid::setupNode(const String& model, const String& material, const String& nodeName, bool setupShape)
+// common part of creating new scene node with model, collision shape and physics components, node is child of scene
+// unless parent is given
+Node* Arkanoid::setupNode(const String& model, const String& material, const String& nodeName, bool setupShape, bool setupBody,
+                          Node* parent)
 {
     ResourceCache* cache = GetSubsystem<ResourceCache>();
-    Node* node = scene_->CreateChild(nodeName);
+    Node* node = (nullptr != parent ? parent : scene_.Get())->CreateChild(nodeName);
     //node->SetPosition(Vector3(0, 0, 0));
     Model* objectModel = cache->GetResource<Model>(model);
     StaticModel* staticModel = node->CreateComponent<StaticModel>();
@@ -90,146 +162,193 @@ Node* Arkanoid::setupNode(const String& model, const String& material, const Str
         shape->SetMargin(0.00001f);
         shape->SetConvexHull(objectModel);
     }
-    setupPhysicalProperties(node->CreateComponent<RigidBody>());
-    
+    if (false != setupBody)
+    {
+        setupPhysicalProperties(node->CreateComponent<RigidBody>());
+    }
+
     return node;
 }
 
-// remove all bricks nodes
+// fits octree to the field, octants of its deepest level are about brick size
+void Arkanoid::configureOctree(float brickWidth)
+{
+    unsigned levels = LogBaseTwo(unsigned(SCENE_BOUNDS.Size().x_ / brickWidth)) + 1;
+    scene_->GetComponent<Octree>()->SetSize(SCENE_BOUNDS, Clamp(levels, 1U, 8U));
+}
+
+// measures object models, so game core and octree use their sizes
+void Arkanoid::configureCore()
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    GameConfig config;
+    BoundingBox brickBox = cache->GetResource<Model>("Models/Brick_Blue.mdl")->GetBoundingBox();
+    config.brickWidth_ = brickBox.max_.x_ - brickBox.min_.x_;
+    config.brickHeight_ = brickBox.max_.y_ - brickBox.min_.y_;
+    BoundingBox paddleBox = cache->GetResource<Model>("Models/Paddle.mdl")->GetBoundingBox();
+    config.paddleHalfWidth_ = paddleBox.max_.x_;
+    config.paddleHalfHeight_ = 0.5f * (paddleBox.max_.y_ - paddleBox.min_.y_);
+    config.paddleY_ = paddleNode_->GetPosition().y_;
+    BoundingBox ballBox = cache->GetResource<Model>("Models/Ball.mdl")->GetBoundingBox();
+    config.ballRadius_ = (ballBox.max_ - ballBox.min_).Length() * 0.5f / Sqrt(3.0f);
+    config.ballOffsetY_ = ballOffset_.y_;
+    BoundingBox bonusBox = cache->GetResource<Model>("Models/ExtendPaddle.mdl")->GetBoundingBox();
+    config.bonusHalfWidth_ = 0.5f * (bonusBox.max_.x_ - bonusBox.min_.x_);
+    config.bonusHalfHeight_ = 0.5f * (bonusBox.max_.y_ - bonusBox.min_.y_);
+    core_.Configure(config);
+    core_.SetJobRunner(&jobRunner_);
+    configureOctree(config.brickWidth_);
+}
+
+// remove all bricks and bonuses nodes
 void Arkanoid::clearLevel()
 {
-    clearBonuses();
-    for (unsigned i = 0; i < bricks_.Size(); i ++)
+    HiresTimer teardownTimer;
+    // nodes of removed entities are only disabled, all nodes of the level go at once from the end of child lists of
+    // their groups instead of being searched for and erased one by one
+    if (0 != nodeCapacity_)
     {
-        if (nullptr != bricks_[i])
+        bricksNode_->RemoveAllChildren();
+        bonusesNode_->RemoveAllChildren();
+        brickField_.Reset();
+        if (false != benchmark_)
         {
-            bricks_[i]->Remove();
-            bricks_[i].Reset();
+            levelTeardownTimes_.Push(teardownTimer.GetUSec(false) * 0.001f);
         }
     }
-    bricks_.Clear();
+    // all per-level records are released at once
+    brickNodes_ = nullptr;
+    bonusNodes_ = nullptr;
+    nodeCapacity_ = 0;
+    levelArena_.Reset();
+    levelReady_ = false;
 }
 
-// removes all active (flying down) bonuses
-void Arkanoid::clearActiveBonuses()
+// creates nodes for bricks and bonuses of current game core level
+void Arkanoid::prepareLevel()
 {
-    for (unsigned i = 0; i < bonuses_.Size(); i ++)
+    levelChangePending_ = false;
+    clearLevel();
+    HiresTimer buildTimer;
+
+    static const char* models[] = { "Models/Brick_Yellow.mdl", "Models/Brick_Red.mdl", "Models/Brick_Green.mdl", "Models/Brick_Blue.mdl" };
+    static const char* materials[] = { "Materials/Brick_Yellow.xml", "Materials/Brick_Red.xml", "Materials/Brick_Green.xml", "Materials/Brick_Blue.xml" };
+    static const char* bonusModels[] = { nullptr, "Models/ShrinkPaddle.mdl", "Models/ExtendPaddle.mdl",
+                                         "Models/Bonus100.mdl", "Models/Bonus200.mdl", "Models/Bonus500.mdl",
+                                         "Models/Bonus1000.mdl", "Models/Bonus2000.mdl", "Models/Bonus5000.mdl", "Models/Bonus10000.mdl" };
+    static const char* bonusMaterials[] = { nullptr, "Materials/ShrinkPaddle.xml", "Materials/ExtendPaddle.xml",
+                                            "Materials/Bonus100.xml", "Materials/Bonus200.xml", "Materials/Bonus500.xml",
+                                            "Materials/Bonus1000.xml", "Materials/Bonus2000.xml", "Materials/Bonus5000.xml", "Materials/Bonus10000.xml" };
+    const LevelLayout& layout = core_.GetLayout();
+    nodeCapacity_ = unsigned(layout.countX_ * layout.countY_);
+    brickNodes_ = levelArena_.AllocateArray<Node*>(nodeCapacity_);
+    bonusNodes_ = levelArena_.AllocateArray<Node*>(nodeCapacity_);
+    if (nullptr == brickNodes_
+        || nullptr == bonusNodes_)
     {
-        SharedPtr<Node>& bonusNode = bonuses_[i];
-        if (nullptr != bonusNode
-            && false != bonusNode->IsEnabled())
-        {
-            bonusNode->Remove();
-            bonusNode.Reset();
-        }
+        nodeCapacity_ = 0;
+        ErrorExit("Out of memory for level node tables");
+        return;
     }
-}
-// removes all bonuses
-void Arkanoid::clearBonuses()
-{
-    for (unsigned i = 0; i < bonuses_.Size(); i ++)
+
+    const BrickStore& bricks = core_.GetBricks();
+    for (unsigned i = 0; i < bricks.Size(); i ++)
     {
-        SharedPtr<Node>& bonusNode = bonuses_[i];
-        if (nullptr != bonusNode)
-        {
-            bonusNode->Remove();
-            bonusNode.Reset();
-        }
+        unsigned kind = bricks.GetKinds()[i];
+        EntityHandle brickHandle = bricks.GetHandle(i);
+        Node* brickNode = setupNode(models[kind], materials[kind], "Brick", false, false, bricksNode_);
+        brickNode->SetPosition(Vector3(bricks.GetX()[i], bricks.GetY()[i], 0));
+        brickNode->CreateComponent<Brick>()->SetState(&core_, brickHandle);
+        brickNodes_[brickHandle.slot_] = brickNode;
+    }
+    // brick nodes only show bricks, all of them collide as one static compound body; its rigid body comes after
+    // child shapes, so compound shape and mass are updated once, static body never needs mass again and removed
+    // bricks must not rebuild compound from all remaining children
+    Node* brickFieldNode = bricksNode_->CreateChild("BrickField");
+    brickField_ = brickFieldNode->CreateComponent<BrickField>();
+    brickField_->Build(&core_, GetSubsystem<ResourceCache>()->GetResource<Model>(models[0]));
+    RigidBody* brickFieldBody = brickFieldNode->CreateComponent<RigidBody>();
+    setupPhysicalProperties(brickFieldBody);
+    brickFieldBody->DisableMassUpdate();
+    // bonuses wait disabled inside their bricks, game core moves them without physics bodies
+    const HandleTable<BonusState>& bonuses = core_.GetBonuses();
+    for (unsigned i = 0; i < bonuses.Size(); i ++)
+    {
+        const BonusState& bonus = bonuses[i];
+        EntityHandle bonusHandle = bonuses.GetHandle(i);
+        Node* bonusNode = setupNode(bonusModels[bonus.type_], bonusMaterials[bonus.type_], "Bonus", false, false, bonusesNode_);
+        Bonus* bonusComponent = bonusNode->CreateComponent<Bonus>();
+        bonusComponent->SetState(&core_, bonusHandle);
+        // game core belongs to simulation thread, bonus nodes follow its snapshots
+        bonusComponent->SetEnabled(nullptr == simulation_.Get());
+        bonusNode->SetPosition(Vector3(bonus.x_, bonus.y_, 0));
+        bonusNode->SetEnabled(false);
+        bonusNodes_[bonusHandle.slot_] = bonusNode;
+    }
+    levelReady_ = true;
+    if (false != benchmark_)
+    {
+        levelBuildTimes_.Push(buildTimer.GetUSec(false) * 0.001f);
     }
-    bonuses_.Clear();
 }
-// generates random bricks with bonuses and stores them into bricks_ and bonuses_ vectors
-void Arkanoid::prepareLevel()
+
+// starts ball fly from paddle
+void Arkanoid::launchBall()
 {
-    clearLevel();
+    velocity_ = SPEED_NORMAL;
+    core_.LaunchBall();
+    RigidBody* sphereBody = ballNode_->GetComponent<RigidBody>();
+    sphereBody->ApplyImpulse(Vector3(0, velocity_, 0));
+}
 
-    Paddle* paddle = paddleNode_->GetComponent<Paddle>();
-    paddle->ResetScale();
+// places ball back on paddle
+void Arkanoid::resetBall()
+{
+    RigidBody* ballBody = ballNode_->GetComponent<RigidBody>();
+    ballBody->SetPosition(paddleNode_->GetPosition() + ballOffset_);
+    ballBody->SetLinearVelocity(Vector3(0, 0, 0));
+    ballBody->SetAngularVelocity(Vector3(0, 0, 0));
+}
 
-    ResourceCache* cache = GetSubsystem<ResourceCache>();
-    Model* objectModel = cache->GetResource<Model>("Models/Brick_Blue.mdl");
-    BoundingBox bbbb = objectModel->GetBoundingBox();
-    float width = bbbb.max_.x_ - bbbb.min_.x_;
-    float height = bbbb.max_.y_ - bbbb.min_.y_;
-    if (width > 0
-        && height > 0)
-    {
-        int countX = int(FIELD_WIDTH / width);
-        int countY = int(FIELD_HEIGHT / height);
-        float shiftX = 0.5f * width * (countX - 1);
-        float shiftY = 0.5f * height * (countY - 1);
-        Vector<String> models;
-        models.Push(String("Models/Brick_Yellow.mdl"));
-        models.Push(String("Models/Brick_Red.mdl"));
-        models.Push(String("Models/Brick_Green.mdl"));
-        models.Push(String("Models/Brick_Blue.mdl"));
-        Vector<String> materials;
-        materials.Push(String("Materials/Brick_Yellow.xml"));
-        materials.Push(String("Materials/Brick_Red.xml"));
-        materials.Push(String("Materials/Brick_Green.xml"));
-        materials.Push(String("Materials/Brick_Blue.xml"));
-        for (int j = 0; j < countY * 11 / 16; j ++)
-        {
-            for (int i = 0; i < countX; i ++)
-            {
-                float x = shiftX - i * width;
-                float y = shiftY - j * height;
-                int brickIndex = Random(0, models.Size());
-                String model = models[brickIndex];
-                String material = materials[brickIndex];
-                Node* brickNode = setupNode(model, material, "Brick");
-                brickNode->SetPosition(Vector3(x, y, 0));
-                brickNode->CreateComponent<Brick>();
-                bricks_.Push(SharedPtr<Node>(brickNode));
-
-                unsigned bonusType = Random(BONUS_NONE, BONUS_COUNT);
-                SharedPtr<Node> bonusNode;
-                switch (bonusType)
-                {
-                    case BONUS_EXTENDPADDLE:
-                        bonusNode = SharedPtr<Node>(setupNode("Models/ExtendPaddle.mdl", "Materials/ExtendPaddle.xml", "Bonus"));
-                        break;
-                    case BONUS_SHRINKPADDLE:
-                        bonusNode = SharedPtr<Node>(setupNode("Models/ShrinkPaddle.mdl", "Materials/ShrinkPaddle.xml", "Bonus"));
-                        break;
-                    case BONUS_100:
-                        bonusNode = SharedPtr<Node>(setupNode("Models/Bonus100.mdl", "Materials/Bonus100.xml", "Bonus"));
-                        break;
-                    case BONUS_200:
-                        bonusNode = SharedPtr<Node>(setupNode("Models/Bonus200.mdl", "Materials/Bonus200.xml", "Bonus"));
-                        break;
-                    case BONUS_500:
-                        bonusNode = SharedPtr<Node>(setupNode("Models/Bonus500.mdl", "Materials/Bonus500.xml", "Bonus"));
-                        break;
-                    case BONUS_1000:
-                        bonusNode = SharedPtr<Node>(setupNode("Models/Bonus1000.mdl", "Materials/Bonus1000.xml", "Bonus"));
-                        break;
-                    case BONUS_2000:
-                        bonusNode = SharedPtr<Node>(setupNode("Models/Bonus2000.mdl", "Materials/Bonus2000.xml", "Bonus"));
-                        break;
-                    case BONUS_5000:
-                        bonusNode = SharedPtr<Node>(setupNode("Models/Bonus5000.mdl", "Materials/Bonus5000.xml", "Bonus"));
-                        break;
-                    case BONUS_10000:
-                        bonusNode = SharedPtr<Node>(setupNode("Models/Bonus10000.mdl", "Materials/Bonus10000.xml", "Bonus"));
-                        break;
-                }
-                if (nullptr != bonusNode)
-                {
-                    Bonus* bonus = bonusNode->CreateComponent<Bonus>();
-                    bonus->SetBonusType(bonusType);
-                    RigidBody* bonusBody = bonusNode->GetComponent<RigidBody>();
-                    bonusBody->SetTrigger(true);
-                    bonusBody->SetMass(0.01f);
-                    Vector3 bonusPosition = brickNode->GetPosition();
-                    bonusPosition.z_ = 0;
-                    bonusNode->SetPosition(bonusPosition);
-                    bonusNode->SetEnabled(false);
-                }
-                bonuses_.Push(bonusNode);
-            }
-        }
+// mirrors what has happened in game core in the scene
+void Arkanoid::handleCoreEvents()
+{
+    const GameEvents& events = core_.GetEvents();
+    // new level replaces all nodes, bodies can't be destroyed inside physics step, so game waits for update
+    if (false != events.levelCompleted_)
+    {
+        resetBall();
+        levelReady_ = false;
+        levelChangePending_ = true;
+        core_.ClearEvents();
+        return;
+    }
+    for (unsigned i = 0; i < events.activatedBonusCount_; i ++)
+    {
+        bonusNodes_[events.activatedBonuses_[i].slot_]->SetEnabled(true);
+    }
+    // nodes of removed entities stay disabled until level teardown
+    for (unsigned i = 0; i < events.removedBonusCount_; i ++)
+    {
+        unsigned slot = events.removedBonuses_[i].slot_;
+        bonusNodes_[slot]->SetEnabled(false);
+        bonusNodes_[slot] = nullptr;
+    }
+    // only shrinking bricks have their transforms written, ball passes through them
+    for (unsigned i = 0; i < events.scaledBrickCount_; i ++)
+    {
+        unsigned slot = events.scaledBrickSlots_[i];
+        brickField_->RemoveBrick(slot);
+        brickNodes_[slot]->SetScale(events.brickScales_[i]);
+    }
+    for (unsigned i = 0; i < events.collapsedBrickCount_; i ++)
+    {
+        unsigned slot = events.collapsedBricks_[i].slot_;
+        brickField_->RemoveBrick(slot);
+        brickNodes_[slot]->SetEnabled(false);
+        brickNodes_[slot] = nullptr;
     }
+    core_.ClearEvents();
 }
 
 /**
@@ -240,9 +359,16 @@ void Arkanoid::prepareLevel()
 */
 void Arkanoid::Setup()
 {
+    AllocCounter::SetMainThread();
+#ifdef ARKANOID_ALLOC_COUNTER
+    // with -alloccheck first allocating rally frame terminates application with error exit code
+    allocCheck_ = GetArguments().Contains("-alloccheck");
+#endif
+    parseOptions();
     Ball::RegisterObject(context_);
     Bonus::RegisterObject(context_);
     Brick::RegisterObject(context_);
+    BrickField::RegisterObject(context_);
     Paddle::RegisterObject(context_);
     // These parameters should be self-explanatory.
     // See http://urho3d.github.io/documentation/1.7/_main_loop.html
@@ -260,6 +386,60 @@ void Arkanoid::Setup()
     {
         engineParameters_[EP_RESOURCE_PREFIX_PATHS] = ";../share/Resources;../share/Urho3D/Resources";
     }
+    if (false != headless_)
+    {
+        engineParameters_[EP_HEADLESS] = true;
+        engineParameters_[EP_SOUND] = false;
+    }
+    // many games run at once, they shouldn't write the same log file
+    if (false != simulate_)
+    {
+        engineParameters_[EP_LOG_NAME] = String::EMPTY;
+    }
+}
+
+// -autoplay lets AutoPlayer play the game, so it runs without input;
+// -simthread steps game core on its own thread at fixed rate instead of physics world, scene only shows its state;
+// -quality T starts at rendering quality tier T, 0 is the best one, then quality governor adapts tier to frame time;
+// -physicsfps N [-substeps M] runs physics at N steps per second with at most M substeps per frame, see PhysicsPacer;
+// -benchmark [-seed S] [-frames F] [-output file] plays scripted scenarios of F frames each with autoplay and fixed
+// time step, and writes frame time percentiles of every scenario, startup time, level build and teardown time and, with
+// ARKANOID_ALLOC_COUNTER build option, allocations per frame as JSON, see BenchmarkCompare tool;
+// headless game options:
+// -simulate [-seed S] [-levels L] [-maxtime T] [-result file] plays one game with autopilot and fixed time step until
+// L levels are completed or T seconds of game time pass, and writes its result as JSON;
+// -runner N [-jobs K] [-seed S] [-output file] [-levels L] [-maxtime T] plays N such games with seeds S .. S + N - 1
+// in K child processes at once and writes all results into one JSON file
+void Arkanoid::parseOptions()
+{
+    const Vector<String>& arguments = GetArguments();
+    simulate_ = arguments.Contains("-simulate");
+    benchmark_ = arguments.Contains("-benchmark");
+    autoplay_ = simulate_ || benchmark_ || arguments.Contains("-autoplay");
+    simThread_ = false == simulate_ && false == benchmark_ && arguments.Contains("-simthread");
+    scenarioFrames_ = Max(ToUInt(getOption(arguments, "-frames", "600")), 1U);
+    benchmarkPath_ = getOption(arguments, "-output", "benchmark.json");
+    headless_ = simulate_ || arguments.Contains("-runner");
+    seed_ = ToUInt(getOption(arguments, "-seed", "0"));
+    maxLevels_ = Max(ToUInt(getOption(arguments, "-levels", "1")), 1U);
+    maxTime_ = ToFloat(getOption(arguments, "-maxtime", "600"));
+    resultPath_ = getOption(arguments, "-result", String::EMPTY);
+}
+
+// starts child processes playing headless games
+void Arkanoid::startRunner()
+{
+    const Vector<String>& arguments = GetArguments();
+    unsigned games = ToUInt(getOption(arguments, "-runner", "1"));
+    unsigned jobs = ToUInt(getOption(arguments, "-jobs", String(GetNumLogicalCPUs())));
+    String outputPath = getOption(arguments, "-output", "runner.json");
+    Vector<String> gameArguments;
+    gameArguments.Push("-levels");
+    gameArguments.Push(String(maxLevels_));
+    gameArguments.Push("-maxtime");
+    gameArguments.Push(String(maxTime_));
+    runner_ = new GameRunner(context_);
+    runner_->Start(games, jobs, seed_, outputPath, gameArguments);
 }
 
 // This method is called after the engine has been initialized.
@@ -268,52 +448,46 @@ void Arkanoid::Setup()
 // the engine initialized and ready goes in here.
 void Arkanoid::Start()
 {
-    // frame rate limits
-    engine_->SetMaxFps(40);
-    engine_->SetMaxInactiveFps(10);
+    // runner only waits for its games
+    if (GetArguments().Contains("-runner"))
+    {
+        engine_->SetMaxFps(20);
+        startRunner();
+        return;
+    }
+    // frame rate limits, headless game and benchmark run as fast as they can
+    if (false != simulate_
+        || false != benchmark_)
+    {
+        engine_->SetMaxFps(0);
+    }
+    else
+    {
+        engine_->SetMaxInactiveFps(10);
+        frameScheduler_ = new FrameScheduler(context_);
+        frameScheduler_->Start(ACTIVE_FPS, IDLE_FPS);
+        qualityGovernor_ = new QualityGovernor(context_);
+        qualityGovernor_->Start(ToUInt(getOption(GetArguments(), "-quality", String(DEFAULT_QUALITY_TIER))), frameScheduler_);
+    }
     if (GetPlatform() == "Android" || GetPlatform() == "iOS")
     {
 //         engine_->SetMaxFps(40);
     }
-    else
+    else if (false == headless_)
     {
         Input* input = GetSubsystem<Input>();
         input->SetTouchEmulation(true);
     }
-    // We need to load resources.
-    // If the engine can't find them, check the ResourcePrefixPath (see http://urho3d.github.io/documentation/1.7/_main_loop.html).
-    ResourceCache* cache = GetSubsystem<ResourceCache>();
-
-    // Let's use the default style that comes with Urho3D.
-    UIElement* root = GetSubsystem<UI>()->GetRoot();
-    root->SetDefaultStyle(cache->GetResource<XMLFile>("UI/DefaultStyle.xml"));
-
-    // create pause button and its text
-    pauseButton_ = SharedPtr<Button>(root->CreateChild<Button>());
-    pauseButton_->SetStyleAuto();
-    pauseButton_->SetSize(220, 55);
-    Text* pauseText = pauseButton_->CreateChild<Text>();
-    pauseText->SetAlignment(HA_CENTER, VA_CENTER);
-    pauseText->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 24);
-    pauseText->SetText("Pause");
-    pauseText->SetTextEffect(TE_SHADOW);
-    pauseText->SetEffectShadowOffset(IntVector2(1, 1));
-    SubscribeToEvent(pauseButton_, E_PRESSED, URHO3D_HANDLER(Arkanoid, handlePause));
-
-    // create score panel and its text
-    scoresPanel_ = SharedPtr<Window>(root->CreateChild<Window>());
-    scoresPanel_->SetSize(360, 60);
-    scoresPanel_->SetColor(Color(1, 1, 1, 0.7f));
-    scoresPanel_->SetStyleAuto();
-    scoresText_ = SharedPtr<Text>(scoresPanel_->CreateChild<Text>());
-    scoresText_->SetText("Score: 0");
-    scoresText_->SetColor(Color(0.1f, 0.5f, 0.1f));
-    scoresText_->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 28);
-    scoresText_->SetHorizontalAlignment(HA_CENTER);
-    scoresText_->SetVerticalAlignment(VA_CENTER);
-    scoresText_->SetTextEffect(TE_STROKE);
-    scoresText_->SetEffectStrokeThickness(1);
-    scoresText_->SetEffectColor(Color(1, 1, 1, 0.5f));
+    // startup is timed by phases, sky, shadows, bricks and music are postponed until first frame is shown,
+    // see finishStartup()
+    HiresTimer phaseTimer;
+    URHO3D_LOGINFOF("Startup phase engine: %.2f ms", startupTimer_.GetUSec(false) * 0.001f);
+    // headless game has no ui
+    if (false == headless_)
+    {
+        createUi();
+    }
+    logStartupPhase("ui", phaseTimer);
 
     // Let's setup a scene to render.
     scene_ = new Scene(context_);
@@ -321,6 +495,9 @@ void Arkanoid::Start()
     physicsWorld_ = scene_->CreateComponent<PhysicsWorld>();
     // no gravity
     physicsWorld_->SetGravity(Vector3(0, 0, 0));
+    physicsPacer_ = new PhysicsPacer(context_);
+    physicsPacer_->Start(scene_, Max(ToInt(getOption(GetArguments(), "-physicsfps", String(PHYSICS_FPS))), 1),
+                         ToInt(getOption(GetArguments(), "-substeps", String(PHYSICS_MAX_SUBSTEPS))));
     // Let the scene have an Octree component!
     scene_->CreateComponent<Octree>();
 
@@ -344,40 +521,13 @@ void Arkanoid::Start()
     skyBody->SetUseGravity(false);
     skyBody->SetAngularVelocity(Vector3(0, 0, 0.01f));
 
-    // models for skybox
-    Node* starsPosXNode = skyNode_->CreateChild("StarsPosX");
-    StaticModel* starsPosXModel = starsPosXNode->CreateComponent<StaticModel>();
-    starsPosXModel->SetModel(cache->GetResource<Model>("Models/Stars_PosX.mdl"));
-    starsPosXModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_PosX.xml"));
-
-    Node* starsPosYNode = skyNode_->CreateChild("StarsPosY");
-    StaticModel* starsPosYModel = starsPosYNode->CreateComponent<StaticModel>();
-    starsPosYModel->SetModel(cache->GetResource<Model>("Models/Stars_PosY.mdl"));
-    starsPosYModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_PosY.xml"));
-
-    Node* starsPosZNode = skyNode_->CreateChild("StarsPosZ");
-    StaticModel* starsPosZModel = starsPosZNode->CreateComponent<StaticModel>();
-    starsPosZModel->SetModel(cache->GetResource<Model>("Models/Stars_PosZ.mdl"));
-    starsPosZModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_PosZ.xml"));
-
-    Node* starsNegXNode = skyNode_->CreateChild("StarsNegX");
-    StaticModel* starsNegXModel = starsNegXNode->CreateComponent<StaticModel>();
-    starsNegXModel->SetModel(cache->GetResource<Model>("Models/Stars_NegX.mdl"));
-    starsNegXModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_NegX.xml"));
-
-    Node* starsNegYNode = skyNode_->CreateChild("StarsNegY");
-    StaticModel* starsNegYModel = starsNegYNode->CreateComponent<StaticModel>();
-    starsNegYModel->SetModel(cache->GetResource<Model>("Models/Stars_NegY.mdl"));
-    starsNegYModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_NegY.xml"));
-
-    Node* starsNegZNode = skyNode_->CreateChild("StarsNegZ");
-    StaticModel* starsNegZModel = starsNegZNode->CreateComponent<StaticModel>();
-    starsNegZModel->SetModel(cache->GetResource<Model>("Models/Stars_NegZ.mdl"));
-    starsNegZModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_NegZ.xml"));
+    // bricks and bonuses of current level are grouped, so level teardown removes them in one go
+    bricksNode_ = scene_->CreateChild("Bricks");
+    bonusesNode_ = scene_->CreateChild("Bonuses");
 
     // create paddle
     paddleNode_ = setupNode("Models/Paddle.mdl", "Materials/Paddle.xml", "Paddle");
-    paddleNode_->CreateComponent<Paddle>();
+    paddleNode_->CreateComponent<Paddle>()->SetState(&core_);
     paddleNode_->SetPosition(Vector3(0, -0.9f, 0));
 
     // create ball
@@ -389,7 +539,7 @@ void Arkanoid::Start()
     ballNode_->SetPosition(paddleNode_->GetPosition()
                             + Vector3(0, 0.075f, ball->GetRadius()));
     // remember ball offset relative to paddle
-    ballOffsetOriginal_ = ballOffset_ = ballNode_->GetPosition() - paddleNode_->GetPosition();
+    ballOffset_ = ballNode_->GetPosition() - paddleNode_->GetPosition();
 
     // create some glass looking ceiling
     fieldNode_ = setupNode("Models/FieldFloor.mdl", "Materials/FieldFloor.xml", "FieldFloor", false);
@@ -410,6 +560,7 @@ void Arkanoid::Start()
     CollisionShape* fbShape5 = fieldBordersNode_->CreateComponent<CollisionShape>();
     fbShape5->SetStaticPlane(Vector3(0, 0.5f * FIELD_HEIGHT, 0), Quaternion(180, 0, 0));
     fbShape5->SetMargin(0.001f);
+    logStartupPhase("scene", phaseTimer);
 
     // A camera from which the viewport can render.
     cameraNode_ = scene_->CreateChild("Camera");
@@ -421,21 +572,24 @@ void Arkanoid::Start()
     camera->SetNearClip(0.1f);
     camera->SetFarClip(20);
 
-    // Create directional light
-    Node* lightNode = skyNode_->CreateChild();
-    lightNode->SetDirection(Vector3::FORWARD);
-    lightNode->Yaw(180);      // horizontal
-    lightNode->Pitch(70);   // vertical
-    Light* light = lightNode->CreateComponent<Light>();
+    // Create directional light, it casts shadows after the first frame
+    lightNode_ = skyNode_->CreateChild();
+    lightNode_->SetDirection(Vector3::FORWARD);
+    lightNode_->Yaw(180);      // horizontal
+    lightNode_->Pitch(70);   // vertical
+    Light* light = lightNode_->CreateComponent<Light>();
     light->SetLightType(LIGHT_DIRECTIONAL);
     light->SetBrightness(1.6);
     light->SetColor(Color(1.0f, 1.0f, 0.5f, 1));
-    light->SetCastShadows(true);
+    light->SetCastShadows(false);
 
     // Setup the viewport.
     Renderer* renderer = GetSubsystem<Renderer>();
-    SharedPtr<Viewport> viewport(new Viewport(context_, scene_, cameraNode_->GetComponent<Camera>()));
-    renderer->SetViewport(0, viewport);
+    if (nullptr != renderer)
+    {
+        SharedPtr<Viewport> viewport(new Viewport(context_, scene_, cameraNode_->GetComponent<Camera>()));
+        renderer->SetViewport(0, viewport);
+    }
     // create music component
     musicSource_ = scene_->CreateComponent<SoundSource>();
     // Set the sound type to music so that master volume control works correctly
@@ -443,10 +597,114 @@ void Arkanoid::Start()
     // Subscribe to the events to handle.
     SubscribeToEvent(E_KEYDOWN, URHO3D_HANDLER(Arkanoid, handleKeyDown));
     SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(Arkanoid, handleUpdate));
+    SubscribeToEvent(E_SCREENMODE, URHO3D_HANDLER(Arkanoid, handleScreenMode));
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(Arkanoid, handleBeginFrame));
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(Arkanoid, handleEndFrame));
+    // game rules run once per physics step
+    SubscribeToEvent(physicsWorld_, E_PHYSICSPRESTEP, URHO3D_HANDLER(Arkanoid, handlePhysicsPreStep));
+    SubscribeToEvent(physicsWorld_, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(Arkanoid, handlePhysicsPostStep));
+    // game state is ready at once, its bricks get nodes after the first frame
+    configureCore();
+    core_.NewGame(GetArguments().Contains("-seed") ? seed_ : Rand());
+    logStartupPhase("camera and game", phaseTimer);
+}
+
+// creates content which is not needed for the first frame, called at the end of the first frame
+void Arkanoid::finishStartup()
+{
+    // We need to load resources.
+    // If the engine can't find them, check the ResourcePrefixPath (see http://urho3d.github.io/documentation/1.7/_main_loop.html).
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    HiresTimer phaseTimer;
+
+    // models for skybox
+    Node* starsPosXNode = skyNode_->CreateChild("StarsPosX");
+    StaticModel* starsPosXModel = starsPosXNode->CreateComponent<StaticModel>();
+    starsPosXModel->SetModel(cache->GetResource<Model>("Models/Stars_PosX.mdl"));
+    starsPosXModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_PosX.xml"));
+
+    Node* starsPosYNode = skyNode_->CreateChild("StarsPosY");
+    StaticModel* starsPosYModel = starsPosYNode->CreateComponent<StaticModel>();
+    starsPosYModel->SetModel(cache->GetResource<Model>("Models/Stars_PosY.mdl"));
+    starsPosYModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_PosY.xml"));
+
+    Node* starsPosZNode = skyNode_->CreateChild("StarsPosZ");
+    StaticModel* starsPosZModel = starsPosZNode->CreateComponent<StaticModel>();
+    starsPosZModel->SetModel(cache->GetResource<Model>("Models/Stars_PosZ.mdl"));
+    starsPosZModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_PosZ.xml"));
+
+    Node* starsNegXNode = skyNode_->CreateChild("StarsNegX");
+    StaticModel* starsNegXModel = starsNegXNode->CreateComponent<StaticModel>();
+    starsNegXModel->SetModel(cache->GetResource<Model>("Models/Stars_NegX.mdl"));
+    starsNegXModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_NegX.xml"));
+
+    Node* starsNegYNode = skyNode_->CreateChild("StarsNegY");
+    StaticModel* starsNegYModel = starsNegYNode->CreateComponent<StaticModel>();
+    starsNegYModel->SetModel(cache->GetResource<Model>("Models/Stars_NegY.mdl"));
+    starsNegYModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_NegY.xml"));
+
+    Node* starsNegZNode = skyNode_->CreateChild("StarsNegZ");
+    StaticModel* starsNegZModel = starsNegZNode->CreateComponent<StaticModel>();
+    starsNegZModel->SetModel(cache->GetResource<Model>("Models/Stars_NegZ.mdl"));
+    starsNegZModel->SetMaterial(cache->GetResource<Material>("Materials/Stars_NegZ.xml"));
+
+    lightNode_->GetComponent<Light>()->SetCastShadows(true);
+    logStartupPhase("sky and shadows", phaseTimer);
+
     // fill field with bricks
     prepareLevel();
-    
+    if (false != benchmark_)
+    {
+        profiler_ = new FrameProfiler(context_);
+        profiler_->Start(scene_);
+        startScenario(0);
+    }
+    if (false != simThread_)
+    {
+        startSimulationThread();
+    }
+    logStartupPhase("level", phaseTimer);
+
     startMusic();
+    logStartupPhase("music", phaseTimer);
+}
+
+// creates pause button and scores panel
+void Arkanoid::createUi()
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    // Let's use the default style that comes with Urho3D.
+    UIElement* root = GetSubsystem<UI>()->GetRoot();
+    root->SetDefaultStyle(cache->GetResource<XMLFile>("UI/DefaultStyle.xml"));
+
+    // create pause button and its text
+    pauseButton_ = SharedPtr<Button>(root->CreateChild<Button>());
+    pauseButton_->SetStyleAuto();
+    pauseButton_->SetSize(220, 55);
+    Text* pauseText = pauseButton_->CreateChild<Text>();
+    pauseText->SetAlignment(HA_CENTER, VA_CENTER);
+    pauseText->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 24);
+    pauseText->SetText("Pause");
+    pauseText->SetTextEffect(TE_SHADOW);
+    pauseText->SetEffectShadowOffset(IntVector2(1, 1));
+    SubscribeToEvent(pauseButton_, E_PRESSED, URHO3D_HANDLER(Arkanoid, handlePause));
+
+    // create score panel and its text
+    scoresPanel_ = SharedPtr<Window>(root->CreateChild<Window>());
+    scoresPanel_->SetSize(360, 60);
+    scoresPanel_->SetColor(Color(1, 1, 1, 0.7f));
+    scoresPanel_->SetStyleAuto();
+    scoresText_ = SharedPtr<Text>(scoresPanel_->CreateChild<Text>());
+    scoresText_->SetColor(Color(0.1f, 0.5f, 0.1f));
+    scoresText_->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 28);
+    scoresText_->SetHorizontalAlignment(HA_CENTER);
+    scoresText_->SetVerticalAlignment(VA_CENTER);
+    scoresText_->SetTextEffect(TE_STROKE);
+    scoresText_->SetEffectStrokeThickness(1);
+    scoresText_->SetEffectColor(Color(1, 1, 1, 0.5f));
+    updateScoresText(core_.GetScores());
+    // ui is scaled and positioned once here and then only when window size changes
+    updateUiLayout();
 }
 
 void Arkanoid::startMusic()
@@ -456,8 +714,10 @@ void Arkanoid::startMusic()
     Sound* music = cache->GetResource<Sound>("Music/Ninja Gods.ogg");
     // Set the song to loop
     music->SetLooped(true);
-    // start playing
+    // start playing, compressed sound is decoded by a stream of sound source in audio thread, piece by piece
     musicSource_->Play(music);
+    URHO3D_LOGINFOF("Music %s: %u bytes of %s data, %u bytes of memory in total", music->GetName().CString(), music->GetDataSize(),
+                    false != music->IsCompressed() ? "compressed" : "decoded", music->GetMemoryUse());
 }
 
 // Good place to get rid of any system resources that requires the
@@ -466,6 +726,11 @@ void Arkanoid::startMusic()
 // for whatever reason (short of a segfault).
 void Arkanoid::Stop()
 {
+#ifdef ARKANOID_ALLOC_COUNTER
+    URHO3D_LOGINFOF("Allocation counter: %u of %u rally frames allocated", allocatingFrames_, rallyFrames_);
+#endif
+    // simulation thread steps game core until it is joined
+    simulation_.Reset();
     clearLevel();
 }
 
@@ -480,11 +745,320 @@ void Arkanoid::handleKeyDown(StringHash eventType, VariantMap& eventData)
     }
 }
 
-// Non-rendering logic should be handled here.
-// This could be moving objects, checking collisions and reaction, etc.
-void Arkanoid::handleUpdate(StringHash eventType, VariantMap& eventData)
+void Arkanoid::handleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+#ifdef ARKANOID_ALLOC_COUNTER
+    AllocCounter::BeginFrame();
+#endif
+    if (false != simulate_
+        || false != benchmark_)
+    {
+        // applies to the frame after this one
+        engine_->SetNextTimeStep(SIMULATION_TIME_STEP);
+        frameTimer_.Reset();
+    }
+    if (nullptr != profiler_)
+    {
+        profiler_->BeginFrame();
+    }
+}
+
+void Arkanoid::handleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+#ifdef ARKANOID_ALLOC_COUNTER
+    checkFrameAllocations();
+#endif
+    // the first frame is shown, the rest of content can be created now
+    if (0 == startupTime_)
+    {
+        startupTime_ = startupTimer_.GetUSec(false) * 0.001f;
+        URHO3D_LOGINFOF("Startup: first frame after %.2f ms", startupTime_);
+        finishStartup();
+        return;
+    }
+    if (false != simulate_)
+    {
+        updateSimulation();
+    }
+    if (nullptr != profiler_)
+    {
+        profiler_->EndFrame();
+        updateBenchmark();
+    }
+}
+
+// starts benchmark scenario on fixed seed
+void Arkanoid::startScenario(unsigned scenario)
+{
+    benchmarkScenario_ = scenario;
+    scenarioFrame_ = 0;
+    if (false != paused_)
+    {
+        togglePause();
+    }
+    core_.NewGame(seed_);
+    resetBall();
+    prepareLevel();
+    if (BENCHMARK_FALLING_BONUSES == scenario)
+    {
+        // bricks with bonuses in lower half of the field release their bonuses at once
+        const LevelLayout& layout = core_.GetLayout();
+        float middleY = layout.shiftY_ - 0.5f * layout.countY_ * layout.brickHeight_;
+        const BrickStore& bricks = core_.GetBricks();
+        for (unsigned i = 0; i < bricks.Size(); i ++)
+        {
+            if (bricks.GetY()[i] < middleY
+                && NULL_HANDLE != bricks.GetBonuses()[i])
+            {
+                core_.HitBrick(bricks.GetHandle(i));
+            }
+        }
+    }
+    profiler_->Clear();
+    physicsPacer_->ResetStats();
+#ifdef ARKANOID_ALLOC_COUNTER
+    scenarioAllocs_ = 0;
+#endif
+}
+
+// runs script of current scenario, called at the end of every frame
+void Arkanoid::updateBenchmark()
+{
+    scenarioFrame_ ++;
+    if (BENCHMARK_LEVEL_TRANSITION == benchmarkScenario_
+        && 0 == scenarioFrame_ % TRANSITION_INTERVAL)
+    {
+        // level completes during next update
+        const BrickStore& bricks = core_.GetBricks();
+        for (unsigned i = 0; i < bricks.Size(); i ++)
+        {
+            core_.HitBrick(bricks.GetHandle(i));
+        }
+    }
+    if (BENCHMARK_PAUSE_RESUME == benchmarkScenario_
+        && 0 == scenarioFrame_ % PAUSE_INTERVAL)
+    {
+        togglePause();
+    }
+    if (scenarioFrame_ >= scenarioFrames_)
+    {
+        finishScenario();
+    }
+}
+
+// stores stats of finished scenario, starts next one or writes results and exits
+void Arkanoid::finishScenario()
+{
+    FrameStats stats[FRAME_PHASE_COUNT];
+    profiler_->Compute(stats);
+    JSONValue scenario;
+    scenario.Set("name", BENCHMARK_NAMES[benchmarkScenario_]);
+    for (unsigned i = 0; i < FRAME_PHASE_COUNT; i ++)
+    {
+        JSONValue phase;
+        stats[i].Save(phase);
+        scenario.Set(FrameProfiler::GetPhaseName(i), phase);
+    }
+    const PhysicsPacerStats& physicsStats = physicsPacer_->GetStats();
+    JSONValue physics;
+    physics.Set("subStepsPerFrame", float(physicsStats.subSteps_) / Max(physicsStats.frames_, 1U));
+    physics.Set("maxSubSteps", physicsStats.maxSubSteps_);
+    physics.Set("timeDroppedMs", physicsStats.timeDropped_ * 1000.0f);
+    physics.Set("timeSlowedMs", physicsStats.timeSlowed_ * 1000.0f);
+    scenario.Set("physics", physics);
+#ifdef ARKANOID_ALLOC_COUNTER
+    scenario.Set("allocsPerFrame", float(scenarioAllocs_) / scenarioFrames_);
+#endif
+    benchmarkResults_.Push(scenario);
+    const FrameStats& frame = stats[FRAME_PHASE_FRAME];
+    URHO3D_LOGINFOF("Benchmark %s: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms", BENCHMARK_NAMES[benchmarkScenario_],
+                    frame.p50_, frame.p95_, frame.p99_, frame.max_);
+    if (benchmarkScenario_ + 1 < BENCHMARK_COUNT)
+    {
+        startScenario(benchmarkScenario_ + 1);
+        return;
+    }
+
+    SharedPtr<JSONFile> result(new JSONFile(context_));
+    JSONValue& root = result->GetRoot();
+    root.Set("seed", seed_);
+    root.Set("framesPerScenario", scenarioFrames_);
+    root.Set("timeStep", SIMULATION_TIME_STEP);
+    root.Set("startupMs", startupTime_);
+    FrameStats levelBuild;
+    levelBuild.Compute(levelBuildTimes_);
+    JSONValue levelBuildValue;
+    levelBuild.Save(levelBuildValue);
+    root.Set("levelBuild", levelBuildValue);
+    FrameStats levelTeardown;
+    levelTeardown.Compute(levelTeardownTimes_);
+    JSONValue levelTeardownValue;
+    levelTeardown.Save(levelTeardownValue);
+    root.Set("levelTeardown", levelTeardownValue);
+    root.Set("scenarios", benchmarkResults_);
+    if (false == result->SaveFile(benchmarkPath_))
+    {
+        ErrorExit("Failed to write benchmark result " + benchmarkPath_);
+    }
+    URHO3D_LOGINFOF("Benchmark results written to %s", benchmarkPath_.CString());
+    profiler_.Reset();
+    engine_->Exit();
+}
+
+// collects frame time and ends headless game when it has played enough
+void Arkanoid::updateSimulation()
+{
+    if (false != simulationDone_)
+    {
+        return;
+    }
+    frameTimes_.Push(frameTimer_.GetUSec(false) * 0.001f);
+    if (core_.GetLevel() > maxLevels_
+        || time_ >= maxTime_)
+    {
+        finishSimulation();
+    }
+}
+
+// writes result of headless game and exits
+void Arkanoid::finishSimulation()
+{
+    simulationDone_ = true;
+    SharedPtr<JSONFile> result(new JSONFile(context_));
+    JSONValue& root = result->GetRoot();
+    root.Set("seed", seed_);
+    root.Set("scores", core_.GetScores());
+    root.Set("levels", core_.GetLevel() - 1);
+    root.Set("lostBalls", lostBalls_);
+    root.Set("gameTime", time_);
+    FrameStats frameStats;
+    frameStats.Compute(frameTimes_);
+    JSONValue frameTime;
+    frameStats.Save(frameTime);
+    root.Set("frameTime", frameTime);
+    if (false == resultPath_.Empty())
+    {
+        if (false == result->SaveFile(resultPath_))
+        {
+            ErrorExit("Failed to write game result " + resultPath_);
+        }
+    }
+    else
+    {
+        URHO3D_LOGINFO(result->ToString());
+    }
+    engine_->Exit();
+}
+
+#ifdef ARKANOID_ALLOC_COUNTER
+// reports frames which allocated while ball is in play, steady rally is expected to allocate nothing
+void Arkanoid::checkFrameAllocations()
+{
+    AllocStats stats;
+    AllocCounter::EndFrame(stats);
+    scenarioAllocs_ += stats.GetTotal();
+    // game core belongs to simulation thread when it runs, its latest snapshot tells where the ball is
+    bool onPaddle = false;
+    if (nullptr != simulation_.Get())
+    {
+        onPaddle = simulation_->LockSnapshot().ball_.onPaddle_;
+        simulation_->UnlockSnapshot();
+    }
+    else
+    {
+        onPaddle = core_.GetBall().onPaddle_;
+    }
+    // frames with paused game, ball on paddle and level change are not part of a rally
+    if (false != paused_
+        || false != onPaddle)
+    {
+        return;
+    }
+    rallyFrames_ ++;
+    if (0 != stats.GetTotal())
+    {
+        allocatingFrames_ ++;
+        URHO3D_LOGWARNINGF("Frame %d allocated %u times (%llu bytes) during rally: engine %u, game %u, ui %u, audio %u, workers %u",
+                           framecount_, stats.GetTotal(), stats.bytes_,
+                           stats.counts_[ALLOC_SCOPE_ENGINE], stats.counts_[ALLOC_SCOPE_GAME], stats.counts_[ALLOC_SCOPE_UI],
+                           stats.counts_[ALLOC_SCOPE_AUDIO], stats.counts_[ALLOC_SCOPE_WORKER]);
+        if (false != allocCheck_)
+        {
+            ErrorExit("Allocation check failed: rally frame allocated");
+        }
+    }
+}
+#endif
+
+// ball speed is kept before every physics step, autoplay decides paddle target there too
+void Arkanoid::handlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
 {
-    // ui should be resized if we resize window
+    ALLOC_SCOPE(ALLOC_SCOPE_GAME);
+    if (false != paused_
+        || false == levelReady_)
+    {
+        return;
+    }
+    RigidBody* ballBody = ballNode_->GetComponent<RigidBody>();
+    if (false != autoplay_)
+    {
+        if (false != core_.GetBall().onPaddle_)
+        {
+            launchBall();
+        }
+        // predictor works on core state, so ball flown by physics is copied there
+        Vector3 ballPosition = ballBody->GetPosition();
+        Vector3 ballVelocity = ballBody->GetLinearVelocity();
+        core_.SetBall(ballPosition.x_, ballPosition.y_, ballVelocity.x_, ballVelocity.y_);
+        paddleNode_->GetComponent<Paddle>()->MovePaddle(AutoPlayer::GetPaddleTarget(core_));
+    }
+    if (false == core_.GetBall().onPaddle_)
+    {
+        Vector3 ballVelocity = ballBody->GetLinearVelocity();
+        // ensure ball has y-velocity != 0 to prevent ethernal loop and make sure velocity is the same all the time
+        GameCore::ClampBallVelocity(ballVelocity.x_, ballVelocity.y_, velocity_);
+        ballVelocity.z_ = 0;
+        ballBody->SetLinearVelocity(ballVelocity);
+    }
+}
+
+// game rules run after every physics step with its fixed time step, so they don't depend on frame rate;
+// collisions of the step have been reported already
+void Arkanoid::handlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPostStep;
+    ALLOC_SCOPE(ALLOC_SCOPE_GAME);
+    if (false != paused_
+        || false == levelReady_)
+    {
+        return;
+    }
+    // if ball is outside field, place it back on paddle, game core removes bonuses and resets paddle size
+    if (false == core_.GetBall().onPaddle_
+        && false != GameCore::IsBallOut(ballNode_->GetPosition().y_))
+    {
+        core_.LoseBall();
+        resetBall();
+        lostBalls_ ++;
+    }
+    float timeStep = eventData[P_TIMESTEP].GetFloat();
+    // bonuses fall, stack and get caught in game core, physics world doesn't know them
+    core_.MoveBonuses(timeStep);
+    // apply game rules: paddle motion, scores, bonuses, brick collapse and next level
+    core_.Update(timeStep);
+    handleCoreEvents();
+}
+
+// ui should be resized if we resize window
+void Arkanoid::handleScreenMode(StringHash eventType, VariantMap& eventData)
+{
+    updateUiLayout();
+}
+
+// scales ui to window size and positions ui elements
+void Arkanoid::updateUiLayout()
+{
+    ALLOC_SCOPE(ALLOC_SCOPE_UI);
     UI* ui = GetSubsystem<UI>();
     Graphics* graphics = GetSubsystem<Graphics>();
     float scaleX = graphics->GetWidth() / float(BASE_WIDTH);
@@ -494,22 +1068,193 @@ void Arkanoid::handleUpdate(StringHash eventType, VariantMap& eventData)
     // also position ui elements
     pauseButton_->SetPosition(graphics->GetWidth() / sc - pauseButton_->GetWidth(), 0);
     scoresPanel_->SetPosition((graphics->GetWidth() / sc - scoresPanel_->GetWidth()) / 2, 0);
+}
+
+// sets scores text, formatting goes to stack buffer and scoresString_ keeps its capacity between calls
+void Arkanoid::updateScoresText(unsigned scores)
+{
+    ALLOC_SCOPE(ALLOC_SCOPE_UI);
+    if (nullptr == scoresText_)
+    {
+        return;
+    }
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "Scores: %u", scores);
+    scoresString_ = buffer;
+    scoresText_->SetText(scoresString_);
+    shownScores_ = scores;
+}
+
+// returns x-coordinate of field floor point under screen position, at height of paddle on screen
+float Arkanoid::getFieldX(const IntVector2& position)
+{
+    Camera* camera = cameraNode_->GetComponent<Camera>();
+    Graphics* graphics = GetSubsystem<Graphics>();
+    // get paddle center screen position
+    Vector2 paddleScreenPos = camera->WorldToScreenPoint(paddleNode_->GetPosition());
+    // take x-coordinate from touch, and y-coordinate from projected paddle center
+    // you may want to use both coordinates from touch
+    Ray ray = camera->GetScreenRay(float(position.x_) / graphics->GetWidth(), paddleScreenPos.y_);
+    // get ray intersection with floor, z = 0, normal is 0, 0, 1
+    float hitDistance = ray.HitDistance(Plane(Vector3(0, 0, 1), Vector3(0, 0, 0)));
+    // get point from distance on ray
+    Vector3 hitPoint = ray.origin_ + ray.direction_ * hitDistance;
+    return hitPoint.x_;
+}
+
+// game core steps on its own thread from now on, scene only mirrors its snapshots
+void Arkanoid::startSimulationThread()
+{
+    // game core moves ball and bonuses itself, physics world would fight it
+    physicsWorld_->SetUpdateEnabled(false);
+    // paddle and bonus components read game core, their nodes follow snapshots instead
+    paddleNode_->GetComponent<Paddle>()->SetEnabled(false);
+    for (unsigned i = 0; i < nodeCapacity_; i ++)
+    {
+        if (nullptr != bonusNodes_[i])
+        {
+            bonusNodes_[i]->GetComponent<Bonus>()->SetEnabled(false);
+        }
+    }
+    shownLevel_ = core_.GetLevel();
+    // work queue is completed from main thread only
+    core_.SetJobRunner(nullptr);
+    simulation_.Reset(new GameSimulation(core_, SIMULATION_THREAD_STEP));
+    simulation_->SetAutoplay(autoplay_);
+    simulation_->SetPaused(paused_);
+    simulation_->Start();
+    URHO3D_LOGINFOF("Game core runs on simulation thread at %.0f steps per second", 1.0f / SIMULATION_THREAD_STEP);
+}
+
+// passes input to simulation thread and mirrors its latest snapshot in the scene
+void Arkanoid::updateFromSimulation(unsigned touches, float timeStep)
+{
+    Input* input = GetSubsystem<Input>();
+    GameInput gameInput = GameInput();
+    gameInput.speed_ = SPEED_NORMAL;
+    if (touches > 0
+        && nullptr == GetSubsystem<UI>()->GetFocusElement()
+        && false == paused_)
+    {
+        TouchState* ts = input->GetTouch(0);
+        if (nullptr == ts->touchedElement_)
+        {
+            gameInput.paddleTargetX_ = getFieldX(ts->position_);
+            gameInput.movePaddle_ = true;
+        }
+        gameInput.launch_ = touches > 1 && nullptr == input->GetTouch(1)->touchedElement_;
+    }
+    simulation_->SetInput(gameInput);
+    // sky was rotated by physics world
+    if (false == paused_)
+    {
+        skyNode_->Roll(SKY_ROTATION_SPEED * timeStep);
+    }
 
+    const GameSnapshot& snapshot = simulation_->LockSnapshot();
+    // snapshot may lag behind level built from game core, new level needs its nodes
+    if (snapshot.level_ != shownLevel_)
+    {
+        bool newLevel = snapshot.level_ > shownLevel_;
+        simulation_->UnlockSnapshot();
+        if (false != newLevel)
+        {
+            simulation_->LockCore();
+            prepareLevel();
+            shownLevel_ = core_.GetLevel();
+            simulation_->UnlockCore();
+        }
+        return;
+    }
+    ballNode_->SetPosition(Vector3(snapshot.ball_.x_, snapshot.ball_.y_, ballOffset_.z_));
+    Vector3 paddlePosition = paddleNode_->GetPosition();
+    paddlePosition.x_ = snapshot.paddle_.x_;
+    paddleNode_->SetPosition(paddlePosition);
+    paddleNode_->SetScale(Vector3(snapshot.paddle_.scale_, 1, 1));
+    unsigned slots = Min(nodeCapacity_, unsigned(snapshot.brickScales_.size()));
+    for (unsigned i = 0; i < slots; i ++)
+    {
+        if (nullptr != brickNodes_[i])
+        {
+            float scale = snapshot.brickScales_[i];
+            if (0 == scale)
+            {
+                brickNodes_[i]->SetEnabled(false);
+                brickNodes_[i] = nullptr;
+            }
+            else if (scale < 1)
+            {
+                brickNodes_[i]->SetScale(scale);
+            }
+        }
+        if (nullptr != bonusNodes_[i])
+        {
+            const BonusState& bonus = snapshot.bonuses_[i];
+            if (BONUS_NONE == bonus.type_)
+            {
+                bonusNodes_[i]->SetEnabled(false);
+                bonusNodes_[i] = nullptr;
+            }
+            else if (false != bonus.active_)
+            {
+                bonusNodes_[i]->SetEnabled(true);
+                bonusNodes_[i]->SetPosition(Vector3(bonus.x_, bonus.y_, 0));
+            }
+        }
+    }
+    unsigned scores = snapshot.scores_;
+    simulation_->UnlockSnapshot();
+    if (scores != shownScores_)
+    {
+        updateScoresText(scores);
+    }
+}
+
+// Non-rendering logic should be handled here.
+// This could be moving objects, checking collisions and reaction, etc.
+void Arkanoid::handleUpdate(StringHash eventType, VariantMap& eventData)
+{
+    ALLOC_SCOPE(ALLOC_SCOPE_GAME);
+    UI* ui = GetSubsystem<UI>();
     float timeStep = eventData[Update::P_TIMESTEP].GetFloat();
     framecount_ ++;
     time_ += timeStep;
+    // scene update with physics steps has run already, so level completed in a step is safe to rebuild now
+    if (false != levelChangePending_)
+    {
+        prepareLevel();
+    }
+    // there is nothing to play until bricks are created after the first frame
+    if (false == levelReady_)
+    {
+        return;
+    }
+    // bricks hit during physics steps of this frame leave brick field body now
+    brickField_->FlushRemovals();
 
     // setup ball speed
     velocity_ = SPEED_NORMAL;
     Input* input = GetSubsystem<Input>();
     unsigned n = input->GetNumTouches();
+    // nothing changes on screen but sky while game is paused or ball waits on paddle untouched;
+    // game core belongs to simulation thread in its mode, so only pause counts there
+    if (nullptr != frameScheduler_)
+    {
+        frameScheduler_->SetIdleAllowed(false != paused_
+                                        || (nullptr == simulation_.Get() && false != core_.GetBall().onPaddle_ && 0 == n));
+    }
+    if (nullptr != simulation_.Get())
+    {
+        updateFromSimulation(n, timeStep);
+        return;
+    }
     // if some one touched screen (or pressed mouse button in touch emulation mode)
     if (n > 0
         && nullptr == ui->GetFocusElement()
         && false == paused_)
     {
-        // if ball offset is different from (0,0,0) then the ball is still on paddle
-        if (0 != ballOffset_.LengthSquared())
+        // ball is still on paddle
+        if (false != core_.GetBall().onPaddle_)
         {
             // update ball position based on ball offset
 //             ballNode_->SetPosition(paddleNode_->GetPosition() + ballOffset_);
@@ -518,10 +1263,7 @@ void Arkanoid::handleUpdate(StringHash eventType, VariantMap& eventData)
                 && nullptr == input->GetTouch(1)->touchedElement_)
             {
                 // start ball fly
-                velocity_ = SPEED_NORMAL;
-                ballOffset_ = Vector3(0, 0, 0);
-                RigidBody* sphereBody = ballNode_->GetComponent<RigidBody>();
-                sphereBody->ApplyImpulse(Vector3(0, velocity_, 0));
+                launchBall();
             }
         }
 #ifdef _DEBUG
@@ -541,132 +1283,21 @@ void Arkanoid::handleUpdate(StringHash eventType, VariantMap& eventData)
         TouchState* ts = input->GetTouch(0);
         if (nullptr == ts->touchedElement_)
         {
-            IntVector2 touchPos = ts->position_;    // touch 2D coordinates
-            
-            Camera* camera = cameraNode_->GetComponent<Camera>();
-            Graphics* graphics = GetSubsystem<Graphics>();
-            // get paddle center screen position
-            Vector2 paddleScreenPos = camera->WorldToScreenPoint(paddleNode_->GetPosition());
-            // take x-coordinate from touch, and y-coordinate from projected paddle center
-            // you may want to use both coordinates from touch
-            Ray ray = camera->GetScreenRay(float(touchPos.x_) / graphics->GetWidth(), paddleScreenPos.y_);
-            // get ray intersection with floor, z = 0, normal is 0, 0, 1
-            float hitDistance = ray.HitDistance(Plane(Vector3(0, 0, 1), Vector3(0, 0, 0)));
-            // get point from distance on ray
-            Vector3 hitPoint = ray.origin_ + ray.direction_ * hitDistance;
             // actually move paddle
             Paddle* paddle = paddleNode_->GetComponent<Paddle>();
-            paddle->MovePaddle(hitPoint.x_);
+            paddle->MovePaddle(getFieldX(ts->position_));
         }
     }
 
-    // if ball is in move
-    RigidBody* ballBody = ballNode_->GetComponent<RigidBody>();
-    if (0 == ballOffset_.LengthSquared())
-    {
-        Vector3 ballVelocity = ballBody->GetLinearVelocity();
-        Vector3 ballVelocity2 = ballVelocity;
-        // ensure ball has y-velocity != 0 to prevent ethernal loop
-        int sign = Sign(ballVelocity.y_);
-        ballVelocity2.y_ = Max(Abs(ballVelocity.y_), 0.05f) * (0 == sign ? 1 : sign);
-        ballVelocity2.z_ = 0;
-//             sphereBody->ApplyImpulse((sphereVelocity2.Normalized() * velocity_ - sphereVelocity));
-        // make sure velocity is the same all the time
-        ballBody->SetLinearVelocity(ballVelocity2.Normalized() * velocity_);
-    }
-    // ball is still on paddle, update ball position based on its offset
-    else
+    // ball is still on paddle, update ball position based on its offset;
+    // the rest of game rules run once per physics step, see handlePhysicsPreStep() and handlePhysicsPostStep()
+    if (false != core_.GetBall().onPaddle_)
     {
         ballNode_->SetPosition(paddleNode_->GetPosition() + ballOffset_);
     }
-
-    // if ball is outside field, place it back on paddle, remove bonuses, reset paddle size
-    if (ballBody->GetPosition().y_ < -0.5f * FIELD_HEIGHT)
+    // set scores text only if scores have changed, text relayout is not free
+    if (core_.GetScores() != shownScores_)
     {
-        ballOffset_ = ballOffsetOriginal_;
-        ballBody->SetPosition(paddleNode_->GetPosition() + ballOffset_);
-        ballBody->SetLinearVelocity(Vector3(0, 0, 0));
-        ballBody->SetAngularVelocity(Vector3(0, 0, 0));
-        clearActiveBonuses();
-        Paddle* paddle = paddleNode_->GetComponent<Paddle>();
-        paddle->ResetScale();
+        updateScoresText(core_.GetScores());
     }
-    // get accumulated by paddle bonuses' scores
-    Paddle* paddle = paddleNode_->GetComponent<Paddle>();
-    scores_ += paddle->GetScores();
-    // find out if there are no more bricks, remove collaped bricks, start bonuses related to collapsing brick
-    bool roundOver = true;
-    for (unsigned i = 0; i < bricks_.Size(); i ++)
-    {
-        // if brick is not removed yet
-        SharedPtr<Node>& brickNode = bricks_[i];
-        if (nullptr != brickNode)
-        {
-            Brick* brick = brickNode->GetComponent<Brick>();
-            if (nullptr != brick)
-            {
-                // if brick is collapsing
-                if (false != brick->IsCollapsing())
-                {
-                    // get scores for collapsing brick
-                    scores_ += brick->GetScores();
-                    // if there is bonus for this brick
-                    SharedPtr<Node>& bonusNode = bonuses_[i];
-                    if (nullptr != bonusNode)
-                    {
-                        // make bonus active
-                        bonusNode->SetEnabled(true);
-                    }
-                }
-                // if brick has collapsed remove it
-                else if (false != brick->IsCollapsed())
-                {
-                    brickNode->Remove();
-                    brickNode.Reset();
-                }
-                else
-                {
-                    // if at least one not collapsing brick still exists the round is not over
-                    roundOver = false;
-                }
-            }
-        }
-    }
-    // if there are no more bricks place ball on paddle and create new bricks for next round
-    if (false != roundOver)
-    {
-        ballOffset_ = ballOffsetOriginal_;
-        ballBody->SetPosition(paddleNode_->GetPosition() + ballOffset_);
-        ballBody->SetLinearVelocity(Vector3(0, 0, 0));
-        ballBody->SetAngularVelocity(Vector3(0, 0, 0));
-        prepareLevel();
-    }
-    // set scores text
-    std::ostringstream scoreStream;
-    scoreStream << std::fixed << "Scores: " << scores_;
-    std::string scoresStr = scoreStream.str();
-    String s(scoresStr.c_str(), scoresStr.size());
-    scoresText_->SetText(s);
-}
-
-// Using the convenient Application API we don't have
-// to worry about initializing the engine or writing a main.
-// You can probably mess around with initializing the engine
-// and running a main manually, but this is convenient and portable.
-
-// This macro is expanded to (roughly, depending on OS) this:
-// 
-// > int RunApplication()
-// > {
-// >     Urho3D::SharedPtr<Urho3D::Context> context(new Urho3D::Context());
-// >     Urho3D::SharedPtr<className> application(new className(context));
-// >     return application->Run();
-// > }
-// >
-// > int main(int argc, char** argv)
-// > {
-// >     Urho3D::ParseArguments(argc, argv);
-// >     return RunApplication();
-// > }
-
-URHO3D_DEFINE_APPLICATION_MAIN(Arkanoid)
+}
@@ -31,6 +31,9 @@
 
 using namespace Urho3D;
 
+/// Number of sound sources reused for hit sounds.
+const unsigned HIT_SOUND_SOURCES = 4;
+
 class Ball : public LogicComponent
 {
     URHO3D_OBJECT(Ball, LogicComponent);
@@ -50,4 +53,5 @@ protected:
     float ballRadius_;
     int scores_;
     SharedPtr<Sound> hitSound_;
+    Vector<SharedPtr<SoundSource> > soundSources_;
 };
@@ -21,23 +21,17 @@
 //
 
 #include <Urho3D/Core/Context.h>
-#include <Urho3D/Graphics/AnimationController.h>
-#include <Urho3D/IO/MemoryBuffer.h>
-#include <Urho3D/Physics/PhysicsEvents.h>
-#include <Urho3D/Physics/PhysicsWorld.h>
-#include <Urho3D/Physics/RigidBody.h>
-#include <Urho3D/Scene/Scene.h>
-#include <Urho3D/Scene/SceneEvents.h>
+#include <Urho3D/Scene/Node.h>
 
 #include "bonus.h"
 
 Bonus::Bonus(Context* context) :
-    LogicComponent(context)
+    LogicComponent(context),
+    core_(nullptr),
+    handle_(NULL_HANDLE)
 {
-    bonusType_ = BONUS_NONE;
-    bonusSpeed_ = 0;
-    // Only the physics update event is needed: unsubscribe from the rest for optimization
-    SetUpdateEventMask(USE_FIXEDUPDATE);
+    // Only the scene update event is needed: unsubscribe from the rest for optimization
+    SetUpdateEventMask(USE_UPDATE);
 }
 
 void Bonus::RegisterObject(Context* context)
@@ -50,45 +44,24 @@ void Bonus::RegisterObject(Context* context)
 //     URHO3D_ATTRIBUTE("Controls Pitch", float, controls_.pitch_, 0.0f, AM_DEFAULT);
 }
 
-void Bonus::Start()
+void Bonus::SetState(GameCore* core, EntityHandle handle)
 {
-    // Component has been inserted into its scene node. Subscribe to events now
-    SubscribeToEvent(GetNode(), E_NODECOLLISION, URHO3D_HANDLER(Bonus, handleNodeCollision));
+    core_ = core;
+    handle_ = handle;
 }
 
-void Bonus::FixedUpdate(float /*timeStep*/)
+unsigned Bonus::GetBonusType()
 {
-    RigidBody* body = GetComponent<RigidBody>();
-    body->SetLinearVelocity(Vector3(0, -bonusSpeed_, 0));
-    Vector3 bonusPosition = body->GetPosition();
-    if (bonusPosition.y_ < -FIELD_HEIGHT * 0.75f)
-    {
-        node_->SetEnabled(false);
-    }
-//     body->GetPosition();
-    bonusSpeed_ = BONUS_SPEED;
+    const BonusState* bonus = nullptr != core_ ? core_->GetBonus(handle_) : nullptr;
+    return nullptr != bonus ? bonus->type_ : unsigned(BONUS_NONE);
 }
 
-void Bonus::handleNodeCollision(StringHash /*eventType*/, VariantMap& eventData)
+void Bonus::Update(float /*timeStep*/)
 {
-    using namespace NodeCollision;
-    Node* otherNode = reinterpret_cast<Node*>(eventData[P_OTHERNODE].GetVoidPtr());
-    if (/*nullptr != otherNode
-        && nullptr != node_
-        && false != node_->IsEnabled()
-        && */String("Bonus") == otherNode->GetName()
-        && node_->GetPosition().y_ > otherNode->GetPosition().y_)
-    {
-        bonusSpeed_ = 0.5f * BONUS_SPEED;
-    }
-
-    MemoryBuffer contacts(eventData[P_CONTACTS].GetBuffer());
-
-    while (!contacts.IsEof())
+    // node is disabled by the game after it handles core events
+    const BonusState* bonus = nullptr != core_ ? core_->GetBonus(handle_) : nullptr;
+    if (nullptr != bonus)
     {
-        /*Vector3 contactPosition = */contacts.ReadVector3();
-        /*Vector3 contactNormal = */contacts.ReadVector3();
-        /*float contactDistance = */contacts.ReadFloat();
-        /*float contactImpulse = */contacts.ReadFloat();
+        node_->SetPosition(Vector3(bonus->x_, bonus->y_, 0));
     }
 }
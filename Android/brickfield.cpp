@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsEvents.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Node.h>
+
+#include <Bullet/BulletCollision/CollisionShapes/btCompoundShape.h>
+#include <Bullet/BulletCollision/NarrowPhaseCollision/btPersistentManifold.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <Bullet/BulletDynamics/Dynamics/btRigidBody.h>
+
+#include "alloccounter.h"
+#include "brickfield.h"
+
+BrickField::BrickField(Context* context) :
+    LogicComponent(context),
+    core_(nullptr),
+    numShapes_(0)
+{
+    // shapes change on game core events, component only listens to collisions
+    SetUpdateEventMask(0);
+}
+
+void BrickField::RegisterObject(Context* context)
+{
+    context->RegisterFactory<BrickField>();
+}
+
+void BrickField::Start()
+{
+    // Component has been inserted into its scene node. Subscribe to events now
+    SubscribeToEvent(GetNode(), E_NODECOLLISION, URHO3D_HANDLER(BrickField, handleNodeCollision));
+}
+
+void BrickField::Build(GameCore* core, Model* brickModel)
+{
+    core_ = core;
+    const LevelLayout& layout = core->GetLayout();
+    shapes_.Resize(unsigned(layout.countX_ * layout.countY_));
+    handles_.Resize(shapes_.Size());
+    removals_.Clear();
+    removals_.Reserve(shapes_.Size());
+    for (unsigned i = 0; i < shapes_.Size(); i ++)
+    {
+        shapes_[i] = nullptr;
+        handles_[i] = NULL_HANDLE;
+    }
+    // convex hull of brick model is built once and cached by physics world, children only have offsets
+    const BrickStore& bricks = core->GetBricks();
+    for (unsigned i = 0; i < bricks.Size(); i ++)
+    {
+        CollisionShape* shape = node_->CreateComponent<CollisionShape>();
+        shape->SetMargin(0.00001f);
+        shape->SetConvexHull(brickModel, 0, Vector3::ONE, Vector3(bricks.GetX()[i], bricks.GetY()[i], 0));
+        unsigned slot = bricks.GetSlot(i);
+        // compound child shape tells brick slot in contacts
+        shape->GetCollisionShape()->setUserIndex(int(slot));
+        shapes_[slot] = shape;
+        handles_[slot] = bricks.GetHandle(i);
+    }
+    numShapes_ = bricks.Size();
+}
+
+void BrickField::RemoveBrick(unsigned slot)
+{
+    // rigid body can't change inside Bullet step, ball keeps bouncing off the shape until the end of frame while
+    // game core ignores further hits of collapsing brick
+    if (slot < shapes_.Size()
+        && nullptr != shapes_[slot])
+    {
+        removals_.Push(shapes_[slot]);
+        shapes_[slot] = nullptr;
+        numShapes_ --;
+    }
+}
+
+void BrickField::FlushRemovals()
+{
+    // disabled shape only takes its own child out of compound, component stays until level teardown
+    for (unsigned i = 0; i < removals_.Size(); i ++)
+    {
+        removals_[i]->SetEnabled(false);
+    }
+    removals_.Clear();
+}
+
+void BrickField::handleNodeCollision(StringHash /*eventType*/, VariantMap& eventData)
+{
+    using namespace NodeCollision;
+    ALLOC_SCOPE(ALLOC_SCOPE_GAME);
+
+    Node* otherNode = reinterpret_cast<Node*>(eventData[P_OTHERNODE].GetVoidPtr());
+    if (otherNode->GetName() != "Ball"
+        || nullptr == core_)
+    {
+        return;
+    }
+    // contacts of the event don't tell which child shape was touched, manifolds of the body pair do
+    RigidBody* body = static_cast<RigidBody*>(eventData[P_BODY].GetPtr());
+    RigidBody* otherBody = static_cast<RigidBody*>(eventData[P_OTHERBODY].GetPtr());
+    const btCollisionObject* fieldObject = body->GetBody();
+    const btCollisionObject* ballObject = otherBody->GetBody();
+    const btCollisionShape* fieldShape = fieldObject->getCollisionShape();
+    btDispatcher* dispatcher = body->GetPhysicsWorld()->GetWorld()->getDispatcher();
+    for (int i = 0; i < dispatcher->getNumManifolds(); i ++)
+    {
+        const btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+        bool fieldFirst = manifold->getBody0() == fieldObject;
+        if (false == (fieldFirst ? manifold->getBody1() == ballObject
+                                 : manifold->getBody0() == ballObject && manifold->getBody1() == fieldObject))
+        {
+            continue;
+        }
+        for (int j = 0; j < manifold->getNumContacts(); j ++)
+        {
+            const btManifoldPoint& point = manifold->getContactPoint(j);
+            const btCollisionShape* childShape = fieldShape;
+            // single brick without offset may be the body shape itself instead of compound child
+            if (false != fieldShape->isCompound())
+            {
+                const btCompoundShape* compound = static_cast<const btCompoundShape*>(fieldShape);
+                int child = fieldFirst ? point.m_index0 : point.m_index1;
+                if (child < 0
+                    || child >= compound->getNumChildShapes())
+                {
+                    continue;
+                }
+                childShape = compound->getChildShape(child);
+            }
+            unsigned slot = unsigned(childShape->getUserIndex());
+            if (slot < handles_.Size())
+            {
+                core_->HitBrick(handles_[slot]);
+            }
+        }
+    }
+}
@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Container/Ptr.h>
+#include <Urho3D/Scene/LogicComponent.h>
+
+#include "gamecore.h"
+
+namespace Urho3D
+{
+class CollisionShape;
+class Model;
+}
+
+using namespace Urho3D;
+
+/// Collision side of intact bricks of current level: child shapes of one static compound body, so physics broadphase
+/// tracks one object instead of one per brick. Child shapes are identified by brick slot; removal of a collapsing
+/// brick is queued during physics step and applied by FlushRemovals() once per frame outside of it. Ball contacts are
+/// mapped back to bricks by compound child shape Bullet reports for them, every child carries slot of its brick as
+/// user index, so removals reordering compound children don't matter.
+class BrickField : public LogicComponent
+{
+    URHO3D_OBJECT(BrickField, LogicComponent);
+public:
+    BrickField(Context* context);
+    /// Register object factory and attributes.
+    static void RegisterObject(Context* context);
+    /// Handle startup. Called by LogicComponent base class.
+    virtual void Start();
+    /// Create child shapes of all bricks of current game core level. Rigid body should be created after this, so
+    /// compound shape is built once instead of after every child.
+    void Build(GameCore* core, Model* brickModel);
+    /// Queue removal of child shape of brick slot, if it is still there. Safe inside physics step.
+    void RemoveBrick(unsigned slot);
+    /// Take queued child shapes out of compound shape. Mass update of rigid body must be disabled, so removals don't
+    /// rebuild compound and mass from all remaining children. Must not be called inside physics step.
+    void FlushRemovals();
+    /// Return number of child shapes.
+    unsigned GetNumBricks() const { return numShapes_; }
+
+private:
+    /// Handle physics collision event.
+    void handleNodeCollision(StringHash eventType, VariantMap& eventData);
+
+    GameCore* core_;
+    /// Child shapes by brick slot, null after removal.
+    PODVector<CollisionShape*> shapes_;
+    /// Brick handles by slot.
+    PODVector<EntityHandle> handles_;
+    /// Child shapes waiting for removal, reserved for all bricks on build.
+    PODVector<CollisionShape*> removals_;
+    unsigned numShapes_;
+};
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Core/Timer.h>
+
+#include "framestats.h"
+
+using namespace Urho3D;
+
+/// Parts of frame CPU time measured by FrameProfiler.
+enum FramePhase
+{
+    /// Whole frame.
+    FRAME_PHASE_FRAME,
+    /// Game logic and scene update without physics.
+    FRAME_PHASE_UPDATE,
+    /// Physics world steps.
+    FRAME_PHASE_PHYSICS,
+    /// Renderer update and view rendering.
+    FRAME_PHASE_RENDER,
+    /// Ui update and rendering.
+    FRAME_PHASE_UI,
+    FRAME_PHASE_COUNT
+};
+
+/// Splits CPU time of every frame into phases by engine event boundaries and collects samples in milliseconds:
+/// update is begin of frame to the end of E_UPDATE handling minus physics steps, ui is the end of E_UPDATE up to
+/// the end of E_POSTUPDATE (ui update) plus the end of view rendering up to the end of rendering, render is the
+/// rest up to the end of view rendering. Profiler handlers must run after game and scene update handlers, so
+/// start it once those have subscribed.
+class FrameProfiler : public Object
+{
+    URHO3D_OBJECT(FrameProfiler, Object);
+public:
+    FrameProfiler(Context* context);
+    /// Start listening to engine events of scene.
+    void Start(Scene* scene);
+    /// Mark frame begin, call from E_BEGINFRAME handler.
+    void BeginFrame();
+    /// Store samples of frame, call from E_ENDFRAME handler.
+    void EndFrame();
+    /// Forget collected samples.
+    void Clear();
+    /// Compute stats of phases from collected samples.
+    void Compute(FrameStats stats[FRAME_PHASE_COUNT]);
+    /// Return name of phase used in reports.
+    static const char* GetPhaseName(unsigned phase);
+
+private:
+    /// Return microseconds since frame begin.
+    long long now() const { return timer_.GetUSec(false); }
+    void handleUpdate(StringHash eventType, VariantMap& eventData);
+    void handlePostUpdate(StringHash eventType, VariantMap& eventData);
+    void handleEndViewRender(StringHash eventType, VariantMap& eventData);
+    void handleEndRendering(StringHash eventType, VariantMap& eventData);
+    void handlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    void handlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+
+    HiresTimer timer_;
+    // phase boundaries of current frame, microseconds since frame begin
+    long long updateEnd_;
+    long long uiUpdateEnd_;
+    long long viewEnd_;
+    long long renderEnd_;
+    long long physicsBegin_;
+    long long physics_;
+    PODVector<float> samples_[FRAME_PHASE_COUNT];
+};
@@ -0,0 +1,45 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "arkanoid.h"
+
+// Using the convenient Application API we don't have
+// to worry about initializing the engine or writing a main.
+// You can probably mess around with initializing the engine
+// and running a main manually, but this is convenient and portable.
+
+// This macro is expanded to (roughly, depending on OS) this:
+// 
+// > int RunApplication()
+// > {
+// >     Urho3D::SharedPtr<Urho3D::Context> context(new Urho3D::Context());
+// >     Urho3D::SharedPtr<className> application(new className(context));
+// >     return application->Run();
+// > }
+// >
+// > int main(int argc, char** argv)
+// > {
+// >     Urho3D::ParseArguments(argc, argv);
+// >     return RunApplication();
+// > }
+
+URHO3D_DEFINE_APPLICATION_MAIN(Arkanoid)
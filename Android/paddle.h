@@ -25,11 +25,11 @@
 #include <Urho3D/Input/Controls.h>
 #include <Urho3D/Scene/LogicComponent.h>
 
-using namespace Urho3D;
+#include "gamecore.h"
 
-const float PADDLE_SPEED = 10.f;
-const float PADDLE_SCALE_SPEED = 1.f;
+using namespace Urho3D;
 
+/// Scene side of the paddle, its motion, size and bonus effects live in GameCore.
 class Paddle : public LogicComponent
 {
     URHO3D_OBJECT(Paddle, LogicComponent);
@@ -37,19 +37,11 @@ public:
     Paddle(Context* context);
     /// Register object factory and attributes.
     static void RegisterObject(Context* context);
-    /// Handle startup. Called by LogicComponent base class.
-    virtual void Start();
     /// Handle physics world update. Called by LogicComponent base class.
     virtual void Update(float timeStep);
-    virtual void ResetScale();
+    /// Attach to game core.
+    void SetState(GameCore* core) { core_ = core; }
     virtual void MovePaddle(float targetX);
-    virtual int GetScores();
 protected:
-    float getTargetScale() { return 0.75f + 0.25f * paddleScale_; }
-    /// Handle physics collision event.
-    void handleNodeCollision(StringHash eventType, VariantMap& eventData);
-
-    float targetX_;
-    int paddleScale_;
-    int scores_;
+    GameCore* core_;
 };
@@ -0,0 +1,173 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Physics/PhysicsEvents.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+#include "physicspacer.h"
+
+namespace
+{
+// capped frames in a row before game time is slowed, and frames under cap before it is sped up again
+const unsigned OVERLOAD_FRAMES = 3;
+const unsigned RECOVERY_FRAMES = 60;
+const float TIME_SCALE_STEP = 0.25f;
+const float MIN_TIME_SCALE = 0.5f;
+}
+
+PhysicsPacer::PhysicsPacer(Context* context) :
+    Object(context),
+    fixedStep_(0),
+    maxSubSteps_(0),
+    frameCap_(0),
+    frameSubSteps_(0),
+    timeAccumulator_(0),
+    timeScale_(1.0f),
+    overloaded_(false),
+    cappedFrames_(0),
+    calmFrames_(0)
+{
+    ResetStats();
+}
+
+void PhysicsPacer::Start(Scene* scene, int fps, int maxSubSteps)
+{
+    scene_ = scene;
+    physicsWorld_ = scene->GetComponent<PhysicsWorld>();
+    fixedStep_ = 1.0f / fps;
+    maxSubSteps_ = Max(maxSubSteps, 1);
+    physicsWorld_->SetFps(fps);
+    physicsWorld_->SetMaxSubSteps(maxSubSteps_);
+    SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(PhysicsPacer, handleSceneUpdate));
+    SubscribeToEvent(physicsWorld_, E_PHYSICSPRESTEP, URHO3D_HANDLER(PhysicsPacer, handlePhysicsPreStep));
+    SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(PhysicsPacer, handleScenePostUpdate));
+    URHO3D_LOGINFOF("Physics runs at %d steps per second, at most %d substeps per frame", fps, maxSubSteps_);
+}
+
+void PhysicsPacer::ResetStats()
+{
+    stats_.frames_ = 0;
+    stats_.subSteps_ = 0;
+    stats_.maxSubSteps_ = 0;
+    stats_.overloadedFrames_ = 0;
+    stats_.timeDropped_ = 0;
+    stats_.timeSlowed_ = 0;
+}
+
+void PhysicsPacer::setTimeScale(float timeScale)
+{
+    timeScale_ = timeScale;
+    scene_->SetTimeScale(timeScale_);
+}
+
+// sets substep cap before physics world is updated
+void PhysicsPacer::handleSceneUpdate(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    frameSubSteps_ = 0;
+    // frame limiter of engine, lower rate of inactive window included
+    Engine* engine = GetSubsystem<Engine>();
+    Input* input = GetSubsystem<Input>();
+    int targetFps = engine->GetMaxFps();
+    if (nullptr != input
+        && false == input->HasFocus())
+    {
+        targetFps = Min(targetFps, engine->GetMaxInactiveFps());
+    }
+    frameCap_ = maxSubSteps_;
+    if (0 < targetFps)
+    {
+        // one more substep for time accumulated over previous frames
+        frameCap_ = Max(maxSubSteps_, CeilToInt(1.0f / (fixedStep_ * targetFps)) + 1);
+    }
+    physicsWorld_->SetMaxSubSteps(frameCap_);
+}
+
+void PhysicsPacer::handlePhysicsPreStep(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    frameSubSteps_ ++;
+}
+
+void PhysicsPacer::handleScenePostUpdate(StringHash /*eventType*/, VariantMap& eventData)
+{
+    // paused game or game core on simulation thread
+    if (false == physicsWorld_->IsUpdateEnabled())
+    {
+        timeAccumulator_ = 0;
+        return;
+    }
+    float timeStep = eventData[ScenePostUpdate::P_TIMESTEP].GetFloat();
+    stats_.frames_ ++;
+    stats_.subSteps_ += frameSubSteps_;
+    stats_.maxSubSteps_ = Max(stats_.maxSubSteps_, frameSubSteps_);
+    stats_.timeSlowed_ += timeStep / timeScale_ - timeStep;
+    if (false != overloaded_)
+    {
+        stats_.overloadedFrames_ ++;
+    }
+    // physics world keeps remainder under one step and drops whole steps over the cap
+    timeAccumulator_ += timeStep - frameSubSteps_ * fixedStep_;
+    bool capped = frameSubSteps_ >= unsigned(frameCap_);
+    if (false != capped
+        && timeAccumulator_ >= fixedStep_)
+    {
+        float dropped = timeAccumulator_ - Mod(timeAccumulator_, fixedStep_);
+        stats_.timeDropped_ += dropped;
+        timeAccumulator_ -= dropped;
+    }
+    timeAccumulator_ = Clamp(timeAccumulator_, 0.0f, fixedStep_);
+
+    if (false != capped)
+    {
+        calmFrames_ = 0;
+        cappedFrames_ ++;
+        if (cappedFrames_ >= OVERLOAD_FRAMES
+            && timeScale_ > MIN_TIME_SCALE)
+        {
+            cappedFrames_ = 0;
+            overloaded_ = true;
+            setTimeScale(Max(timeScale_ - TIME_SCALE_STEP, MIN_TIME_SCALE));
+            URHO3D_LOGWARNINGF("Physics overloaded: %u substeps per frame, %.0f ms of game time dropped so far, "
+                               "time scale %.2f", frameSubSteps_, stats_.timeDropped_ * 1000.0f, timeScale_);
+        }
+    }
+    else if (false != overloaded_)
+    {
+        cappedFrames_ = 0;
+        calmFrames_ ++;
+        if (calmFrames_ >= RECOVERY_FRAMES)
+        {
+            calmFrames_ = 0;
+            setTimeScale(Min(timeScale_ + TIME_SCALE_STEP, 1.0f));
+            overloaded_ = timeScale_ < 1.0f;
+            URHO3D_LOGINFOF("Physics load dropped: time scale %.2f", timeScale_);
+        }
+    }
+    else
+    {
+        cappedFrames_ = 0;
+    }
+}
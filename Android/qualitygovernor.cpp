@@ -0,0 +1,157 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Graphics/GraphicsDefs.h>
+#include <Urho3D/Graphics/GraphicsEvents.h>
+#include <Urho3D/Graphics/Renderer.h>
+#include <Urho3D/IO/Log.h>
+
+#include "framescheduler.h"
+#include "framestats.h"
+#include "qualitygovernor.h"
+
+namespace
+{
+const QualityTier TIERS[] =
+{
+    { "high", true, 1024, QUALITY_HIGH, 60 },
+    { "normal", true, 1024, QUALITY_HIGH, 40 },
+    { "reduced", true, 512, QUALITY_MEDIUM, 40 },
+    { "low", false, 512, QUALITY_LOW, 30 }
+};
+const unsigned TIER_COUNT = sizeof(TIERS) / sizeof(TIERS[0]);
+const unsigned WINDOW_FRAMES = 90;
+// share of frame budget: over it frames are too slow, under it frames of better tier would fit
+const float SLOW_SHARE = 0.9f;
+const float FAST_SHARE = 0.6f;
+const unsigned SLOW_WINDOWS = 2;
+const unsigned FAST_WINDOWS = 5;
+const unsigned COOLDOWN_WINDOWS = 3;
+
+float getBudget(unsigned tier)
+{
+    return 1000.0f / TIERS[tier].maxFps_;
+}
+}
+
+QualityGovernor::QualityGovernor(Context* context) :
+    Object(context),
+    tier_(0),
+    slowWindows_(0),
+    fastWindows_(0),
+    cooldown_(0)
+{
+}
+
+void QualityGovernor::Start(unsigned tier, FrameScheduler* scheduler)
+{
+    scheduler_ = scheduler;
+    samples_.Reserve(WINDOW_FRAMES);
+    applyTier(Min(tier, TIER_COUNT - 1));
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(QualityGovernor, handleBeginFrame));
+    // E_ENDFRAME comes after frame limiter sleep, which would fill every frame up to the budget
+    SubscribeToEvent(E_ENDRENDERING, URHO3D_HANDLER(QualityGovernor, handleEndRendering));
+}
+
+unsigned QualityGovernor::GetNumTiers()
+{
+    return TIER_COUNT;
+}
+
+void QualityGovernor::applyTier(unsigned tier)
+{
+    tier_ = tier;
+    const QualityTier& settings = TIERS[tier_];
+    Renderer* renderer = GetSubsystem<Renderer>();
+    if (nullptr != renderer)
+    {
+        renderer->SetDrawShadows(settings.shadows_);
+        renderer->SetShadowMapSize(settings.shadowMapSize_);
+        renderer->SetMaterialQuality(settings.materialQuality_);
+    }
+    if (nullptr != scheduler_)
+    {
+        scheduler_->SetActiveFps(settings.maxFps_);
+    }
+    slowWindows_ = fastWindows_ = 0;
+    cooldown_ = COOLDOWN_WINDOWS;
+}
+
+void QualityGovernor::evaluate()
+{
+    FrameStats stats;
+    stats.Compute(samples_);
+    samples_.Clear();
+    if (cooldown_ > 0)
+    {
+        cooldown_ --;
+        return;
+    }
+    float budget = getBudget(tier_);
+    if (stats.p95_ > budget * SLOW_SHARE)
+    {
+        fastWindows_ = 0;
+        if (++ slowWindows_ >= SLOW_WINDOWS
+            && tier_ + 1 < TIER_COUNT)
+        {
+            URHO3D_LOGINFOF("Quality governor: p95 frame time %.2f ms over %.2f ms budget, tier %s -> %s", stats.p95_, budget,
+                            TIERS[tier_].name_, TIERS[tier_ + 1].name_);
+            applyTier(tier_ + 1);
+        }
+    }
+    else if (tier_ > 0
+             && stats.p95_ < getBudget(tier_ - 1) * FAST_SHARE)
+    {
+        slowWindows_ = 0;
+        if (++ fastWindows_ >= FAST_WINDOWS)
+        {
+            URHO3D_LOGINFOF("Quality governor: p95 frame time %.2f ms fits %.2f ms budget, tier %s -> %s", stats.p95_,
+                            getBudget(tier_ - 1), TIERS[tier_].name_, TIERS[tier_ - 1].name_);
+            applyTier(tier_ - 1);
+        }
+    }
+    else
+    {
+        slowWindows_ = fastWindows_ = 0;
+    }
+}
+
+void QualityGovernor::handleBeginFrame(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    frameTimer_.Reset();
+}
+
+void QualityGovernor::handleEndRendering(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    // idle frames are cheap and don't tell anything about game frames
+    if (nullptr != scheduler_
+        && false != scheduler_->IsIdle())
+    {
+        return;
+    }
+    samples_.Push(frameTimer_.GetUSec(false) * 0.001f);
+    if (samples_.Size() >= WINDOW_FRAMES)
+    {
+        evaluate();
+    }
+}
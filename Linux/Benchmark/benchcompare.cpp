@@ -0,0 +1,267 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Performance regression gate over results of -benchmark option. Every numeric value of result JSON becomes a metric
+// named by its path, e.g. "scenarios/full_field/frame/p95Ms" (array elements are named by their "name" member). Metrics matched
+// by a tolerance rule are gated: run regresses when current value exceeds baseline * (1 + relative) + absolute.
+// Absolute part of tolerance absorbs timer noise of small values; with several result files the median of every
+// metric is compared, so a single noisy run doesn't fail the gate.
+//
+// Usage: BenchmarkCompare baseline.json result.json [result.json ...] [-tolerances rules.json]
+// rules.json: { "rules": [ { "metric": "*/frame/p95Ms", "relative": 0.1, "absolute": 0.2 } ] }, rules of the file
+// are checked before default ones and the first matching rule applies.
+// Exit code is 0 when nothing regressed, 1 on regression or gated metric missing in results, 2 on bad input.
+
+#include <cstdio>
+
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/Resource/JSONFile.h>
+
+using namespace Urho3D;
+
+namespace
+{
+
+const int EXIT_REGRESSION = 1;
+const int EXIT_BAD_INPUT = 2;
+
+/// Allowed growth of metrics whose name matches pattern, '*' matches any characters.
+struct ToleranceRule
+{
+    String pattern_;
+    float relative_;
+    float absolute_;
+};
+
+// frame time tails are noisier than medians, steady rally frames are expected not to allocate at all
+const ToleranceRule DEFAULT_RULES[] =
+{
+    { "*/frame/p50Ms", 0.05f, 0.1f },
+    { "*/frame/p95Ms", 0.1f, 0.2f },
+    { "*/frame/p99Ms", 0.15f, 0.5f },
+    { "levelBuild/p50Ms", 0.1f, 0.5f },
+    { "levelBuild/p95Ms", 0.15f, 1.0f },
+    { "levelTeardown/p50Ms", 0.1f, 0.5f },
+    { "levelTeardown/p95Ms", 0.15f, 1.0f },
+    { "startupMs", 0.15f, 50.0f },
+    { "*/allocsPerFrame", 0.0f, 0.5f },
+    { "*/physics/timeDroppedMs", 0.0f, 1.0f }
+};
+
+bool matchPattern(const char* pattern, const char* name)
+{
+    if ('*' == *pattern)
+    {
+        // star takes none or more characters of name
+        for (;; name ++)
+        {
+            if (false != matchPattern(pattern + 1, name))
+            {
+                return true;
+            }
+            if (0 == *name)
+            {
+                return false;
+            }
+        }
+    }
+    if (0 == *pattern)
+    {
+        return 0 == *name;
+    }
+    return *pattern == *name && matchPattern(pattern + 1, name + 1);
+}
+
+const ToleranceRule* findRule(const Vector<ToleranceRule>& rules, const String& metric)
+{
+    for (unsigned i = 0; i < rules.Size(); i ++)
+    {
+        if (false != matchPattern(rules[i].pattern_.CString(), metric.CString()))
+        {
+            return &rules[i];
+        }
+    }
+    return nullptr;
+}
+
+// collects numeric values of JSON tree by their paths
+void flatten(const JSONValue& value, const String& path, HashMap<String, float>& metrics)
+{
+    if (false != value.IsNumber())
+    {
+        metrics[path] = value.GetFloat();
+    }
+    else if (false != value.IsObject())
+    {
+        const JSONObject& object = value.GetObject();
+        for (ConstJSONObjectIterator i = object.Begin(); i != object.End(); ++ i)
+        {
+            flatten(i->second_, path.Empty() ? i->first_ : path + "/" + i->first_, metrics);
+        }
+    }
+    else if (false != value.IsArray())
+    {
+        for (unsigned i = 0; i < value.Size(); i ++)
+        {
+            const JSONValue& element = value[i];
+            String name = element.Get("name").IsString() ? element.Get("name").GetString() : String(i);
+            flatten(element, path.Empty() ? name : path + "/" + name, metrics);
+        }
+    }
+}
+
+SharedPtr<JSONFile> loadJson(Context* context, const String& fileName)
+{
+    SharedPtr<JSONFile> file(new JSONFile(context));
+    if (false == file->LoadFile(fileName))
+    {
+        ErrorExit("Failed to load " + fileName, EXIT_BAD_INPUT);
+    }
+    return file;
+}
+
+void loadRules(Context* context, const String& fileName, Vector<ToleranceRule>& rules)
+{
+    const JSONValue& fileRules = loadJson(context, fileName)->GetRoot().Get("rules");
+    for (unsigned i = 0; i < fileRules.Size(); i ++)
+    {
+        const JSONValue& value = fileRules[i];
+        if (false == value.Get("metric").IsString())
+        {
+            ErrorExit("Tolerance rule without metric pattern in " + fileName, EXIT_BAD_INPUT);
+        }
+        ToleranceRule rule = { value.Get("metric").GetString(), value.Get("relative").GetFloat(), value.Get("absolute").GetFloat() };
+        rules.Push(rule);
+    }
+}
+
+float median(PODVector<float>& values)
+{
+    Sort(values.Begin(), values.End());
+    unsigned middle = values.Size() / 2;
+    return 0 != values.Size() % 2 ? values[middle] : 0.5f * (values[middle - 1] + values[middle]);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const Vector<String>& arguments = ParseArguments(argc, argv);
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new FileSystem(context));
+
+    Vector<ToleranceRule> rules;
+    Vector<String> files;
+    for (unsigned i = 0; i < arguments.Size(); i ++)
+    {
+        if (arguments[i] == "-tolerances"
+            && i + 1 < arguments.Size())
+        {
+            loadRules(context, arguments[++ i], rules);
+        }
+        else
+        {
+            files.Push(arguments[i]);
+        }
+    }
+    if (files.Size() < 2)
+    {
+        ErrorExit("Usage: BenchmarkCompare baseline.json result.json [result.json ...] [-tolerances rules.json]", EXIT_BAD_INPUT);
+    }
+    for (unsigned i = 0; i < sizeof(DEFAULT_RULES) / sizeof(DEFAULT_RULES[0]); i ++)
+    {
+        rules.Push(DEFAULT_RULES[i]);
+    }
+
+    HashMap<String, float> baseline;
+    flatten(loadJson(context, files[0])->GetRoot(), String::EMPTY, baseline);
+    HashMap<String, PODVector<float> > runs;
+    for (unsigned i = 1; i < files.Size(); i ++)
+    {
+        HashMap<String, float> metrics;
+        flatten(loadJson(context, files[i])->GetRoot(), String::EMPTY, metrics);
+        for (HashMap<String, float>::ConstIterator j = metrics.Begin(); j != metrics.End(); ++ j)
+        {
+            runs[j->first_].Push(j->second_);
+        }
+    }
+
+    unsigned regressions = 0;
+    unsigned improvements = 0;
+    printf("%-40s %12s %12s %12s  %s\n", "metric", "baseline", "current", "limit", "status");
+    for (HashMap<String, float>::ConstIterator i = baseline.Begin(); i != baseline.End(); ++ i)
+    {
+        const ToleranceRule* rule = findRule(rules, i->first_);
+        if (nullptr == rule)
+        {
+            continue;
+        }
+        float base = i->second_;
+        float limit = base * (1.0f + rule->relative_) + rule->absolute_;
+        HashMap<String, PODVector<float> >::Iterator run = runs.Find(i->first_);
+        // gated metric which disappeared can't be verified, e.g. results built without allocation counter
+        if (runs.End() == run
+            || run->second_.Size() != files.Size() - 1)
+        {
+            printf("%-40s %12.3f %12s %12.3f  MISSING\n", i->first_.CString(), base, "-", limit);
+            regressions ++;
+            continue;
+        }
+        float current = median(run->second_);
+        const char* status = "ok";
+        if (current > limit)
+        {
+            status = "REGRESSED";
+            regressions ++;
+        }
+        else if (current < base * (1.0f - rule->relative_) - rule->absolute_)
+        {
+            status = "improved";
+            improvements ++;
+        }
+        printf("%-40s %12.3f %12.3f %12.3f  %s\n", i->first_.CString(), base, current, limit, status);
+    }
+    for (HashMap<String, PODVector<float> >::ConstIterator i = runs.Begin(); i != runs.End(); ++ i)
+    {
+        if (false == baseline.Contains(i->first_)
+            && nullptr != findRule(rules, i->first_))
+        {
+            printf("%-40s %12s %12s %12s  new, not in baseline\n", i->first_.CString(), "-", "-", "-");
+        }
+    }
+
+    if (0 != improvements)
+    {
+        printf("%u metrics improved beyond tolerance, consider updating baseline\n", improvements);
+    }
+    if (0 != regressions)
+    {
+        printf("%u metrics regressed\n", regressions);
+        return EXIT_REGRESSION;
+    }
+    printf("No regressions in %u result files\n", files.Size() - 1);
+    return 0;
+}
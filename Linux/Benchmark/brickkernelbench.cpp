@@ -0,0 +1,236 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Compares brick collapse processing of BrickStore kernel with the former per-component path,
+// where every brick was a heap allocated component with virtual Update() writing its node scale.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "brickstore.h"
+
+namespace
+{
+
+const float TIME_STEP = 1.0f / 60.0f;
+const unsigned FRAMES = 600;
+// share of intact bricks hit each frame, in 1/10000
+const unsigned HIT_RATE = 20;
+
+/// Deterministic random numbers, same sequence for every path.
+class Lcg
+{
+public:
+    explicit Lcg(unsigned seed) : state_(seed) { }
+    unsigned Next()
+    {
+        state_ = state_ * 1664525u + 1013904223u;
+        return state_ >> 8;
+    }
+private:
+    unsigned state_;
+};
+
+/// Stand-in for scene node transform of former path.
+struct FakeNode
+{
+    float scale_[3];
+    bool dirty_;
+};
+
+/// Former Brick component: own heap object, virtual calls, node write per shrinking brick.
+class ComponentBrick
+{
+public:
+    explicit ComponentBrick(unsigned index) : index_(index), node_(new FakeNode()), scores_(BRICK_SCORES), isCollapsing_(false), isCollapsed_(false), shrinkTime_(0) { }
+    virtual ~ComponentBrick() { delete node_; }
+    virtual void Update(float timeStep)
+    {
+        if (false == isCollapsed_
+            && 0 < shrinkTime_)
+        {
+            shrinkTime_ -= timeStep < shrinkTime_ ? timeStep : shrinkTime_;
+            float scale = shrinkTime_ / SHRINK_TIME;
+            node_->scale_[0] = node_->scale_[1] = node_->scale_[2] = scale;
+            node_->dirty_ = true;
+            isCollapsed_ = shrinkTime_ < 1e-6f;
+        }
+    }
+    virtual void Hit()
+    {
+        if (0 == shrinkTime_)
+        {
+            isCollapsing_ = true;
+            shrinkTime_ = SHRINK_TIME;
+        }
+    }
+    virtual bool IsCollapsing()
+    {
+        bool result = isCollapsing_;
+        isCollapsing_ = false;
+        return result;
+    }
+    virtual bool IsCollapsed() { return isCollapsed_; }
+    virtual int GetScores()
+    {
+        int result = scores_;
+        scores_ = 0;
+        return result;
+    }
+
+    unsigned index_;
+private:
+    FakeNode* node_;
+    int scores_;
+    bool isCollapsing_, isCollapsed_;
+    float shrinkTime_;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+double runComponents(unsigned count, unsigned& scores)
+{
+    std::vector<ComponentBrick*> bricks;
+    // hits pick bricks by their original index, so every path hits the same bricks
+    std::vector<ComponentBrick*> byIndex;
+    for (unsigned i = 0; i < count; i ++)
+    {
+        bricks.push_back(new ComponentBrick(i));
+        byIndex.push_back(bricks.back());
+    }
+    Lcg random(1);
+    scores = 0;
+    Clock::time_point start = Clock::now();
+    for (unsigned frame = 0; frame < FRAMES; frame ++)
+    {
+        unsigned hits = (unsigned)((unsigned long long)count * HIT_RATE / 10000) + 1;
+        for (unsigned h = 0; h < hits; h ++)
+        {
+            ComponentBrick* brick = byIndex[random.Next() % count];
+            if (nullptr != brick)
+            {
+                brick->Hit();
+            }
+        }
+        // component updates, then game scan like former Arkanoid::handleUpdate
+        for (unsigned i = 0; i < bricks.size(); i ++)
+        {
+            bricks[i]->Update(TIME_STEP);
+        }
+        for (unsigned i = (unsigned)bricks.size(); i -- > 0;)
+        {
+            if (false != bricks[i]->IsCollapsing())
+            {
+                scores += bricks[i]->GetScores();
+            }
+            else if (false != bricks[i]->IsCollapsed())
+            {
+                byIndex[bricks[i]->index_] = nullptr;
+                delete bricks[i];
+                bricks[i] = bricks.back();
+                bricks.pop_back();
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (unsigned i = 0; i < bricks.size(); i ++)
+    {
+        delete bricks[i];
+    }
+    return seconds;
+}
+
+double runStore(unsigned count, bool simd, unsigned& scores)
+{
+    LevelArena arena(1024 * 1024);
+    BrickStore store;
+    store.Initialize(arena, count);
+    std::vector<FakeNode> nodes(count);
+    std::vector<EntityHandle> byIndex;
+    for (unsigned i = 0; i < count; i ++)
+    {
+        byIndex.push_back(store.Add(float(i % 64), float(i / 64), (unsigned char)(i % 4), NULL_HANDLE));
+    }
+    Lcg random(1);
+    scores = 0;
+    Clock::time_point start = Clock::now();
+    for (unsigned frame = 0; frame < FRAMES; frame ++)
+    {
+        unsigned hits = (unsigned)((unsigned long long)count * HIT_RATE / 10000) + 1;
+        for (unsigned h = 0; h < hits; h ++)
+        {
+            // hit of removed brick is ignored thanks to stale handle detection
+            store.Hit(byIndex[random.Next() % count]);
+        }
+        BrickUpdateResult result;
+        if (false != simd)
+        {
+            store.Update(TIME_STEP, result);
+        }
+        else
+        {
+            store.UpdateScalar(TIME_STEP, result);
+        }
+        scores += result.scores_;
+        // transforms are written back only for changed bricks
+        for (unsigned i = 0; i < result.scaledCount_; i ++)
+        {
+            FakeNode& node = nodes[result.scaledSlots_[i]];
+            node.scale_[0] = node.scale_[1] = node.scale_[2] = result.scales_[i];
+            node.dirty_ = true;
+        }
+        for (unsigned i = 0; i < result.collapsedCount_; i ++)
+        {
+            store.Remove(result.collapsed_[i]);
+        }
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+}
+
+int main()
+{
+    const unsigned counts[] = { 1000, 10000, 100000 };
+    printf("Brick collapse processing, %u frames, kernel: %s\n", FRAMES, BrickStore::GetKernelName());
+    printf("%8s %16s %16s %16s %10s\n", "bricks", "component ns/f", "scalar ns/f", "kernel ns/f", "speedup");
+    int exitCode = 0;
+    for (unsigned c = 0; c < sizeof(counts) / sizeof(counts[0]); c ++)
+    {
+        unsigned count = counts[c];
+        unsigned componentScores, scalarScores, kernelScores;
+        double component = runComponents(count, componentScores);
+        double scalar = runStore(count, false, scalarScores);
+        double kernel = runStore(count, true, kernelScores);
+        printf("%8u %16.0f %16.0f %16.0f %9.1fx\n", count,
+               component * 1e9 / FRAMES, scalar * 1e9 / FRAMES, kernel * 1e9 / FRAMES, component / kernel);
+        // all paths see the same hits, so they have to agree on scores
+        if (componentScores != scalarScores
+            || scalarScores != kernelScores)
+        {
+            printf("Scores mismatch: component %u, scalar %u, kernel %u\n", componentScores, scalarScores, kernelScores);
+            exitCode = 1;
+        }
+    }
+    return exitCode;
+}
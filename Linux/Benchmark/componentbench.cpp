@@ -0,0 +1,259 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Isolates hot operations of the game with Urho3D in the loop: level construction and teardown for several grid
+// sizes, one update pass and game rules of one physics step, octree culling and physics step against object count,
+// collision event dispatch into components and hit sound playback. Reports ns/op and heap allocations/op, so effect
+// of each optimization is visible on its own.
+
+#include <cstdio>
+
+#include <Urho3D/Graphics/OctreeQuery.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Physics/PhysicsEvents.h>
+
+#include <Bullet/BulletCollision/BroadphaseCollision/btOverlappingPairCache.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+
+#include "arkanoid.h"
+
+namespace
+{
+
+const unsigned LEVEL_ITERATIONS = 20;
+const unsigned UPDATE_ITERATIONS = 1000;
+const unsigned EVENT_ITERATIONS = 10000;
+const unsigned QUERY_ITERATIONS = 10000;
+// octree size of Urho3D when it isn't set
+const float DEFAULT_OCTREE_SIZE = 1000.0f;
+const unsigned DEFAULT_OCTREE_LEVELS = 8;
+// brick size multipliers, smaller bricks make bigger grids
+const float BRICK_SCALES[] = { 1.0f, 0.5f, 0.25f };
+
+}
+
+/// Measures protected parts of Arkanoid, runs headless after the first frame has started scene components.
+class ComponentBenchmark : public Arkanoid
+{
+    URHO3D_OBJECT(ComponentBenchmark, Arkanoid);
+public:
+    ComponentBenchmark(Context* context) : Arkanoid(context), done_(false) { }
+
+    virtual void Setup()
+    {
+        Arkanoid::Setup();
+        headless_ = true;
+        engineParameters_[EP_HEADLESS] = true;
+        engineParameters_[EP_SOUND] = false;
+        engineParameters_[EP_LOG_NAME] = String::EMPTY;
+    }
+    virtual void Start()
+    {
+        Arkanoid::Start();
+        SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(ComponentBenchmark, handlePostUpdate));
+    }
+
+private:
+    void handlePostUpdate(StringHash eventType, VariantMap& eventData)
+    {
+        if (false != done_)
+        {
+            return;
+        }
+        done_ = true;
+        printf("%-40s %8s %12s %12s\n", "operation", "bricks", "ns/op", "allocs/op");
+        GameConfig baseConfig = core_.GetConfig();
+        for (unsigned i = 0; i < sizeof(BRICK_SCALES) / sizeof(BRICK_SCALES[0]); i ++)
+        {
+            GameConfig config = baseConfig;
+            config.brickWidth_ *= BRICK_SCALES[i];
+            config.brickHeight_ *= BRICK_SCALES[i];
+            core_.Configure(config);
+            benchLevel();
+            benchUpdate();
+            benchScene();
+        }
+        core_.Configure(baseConfig);
+        configureOctree(baseConfig.brickWidth_);
+        benchEvents();
+        engine_->Exit();
+    }
+
+    void report(const char* name, unsigned bricks, long long usec, unsigned long long allocs, unsigned iterations)
+    {
+        printf("%-40s %8u %12.0f %12.2f\n", name, bricks, usec * 1000.0 / iterations, double(allocs) / iterations);
+    }
+
+    /// Run operation iterations times and report it.
+    template <class Operation> void measure(const char* name, unsigned bricks, unsigned iterations, Operation operation)
+    {
+        AllocStats stats;
+        HiresTimer timer;
+        AllocCounter::BeginFrame();
+        for (unsigned i = 0; i < iterations; i ++)
+        {
+            operation();
+        }
+        long long usec = timer.GetUSec(false);
+        AllocCounter::EndFrame(stats);
+        report(name, bricks, usec, stats.GetTotal(), iterations);
+    }
+
+    /// Scene construction and teardown of a new level.
+    void benchLevel()
+    {
+        long long prepareTime = 0;
+        long long clearTime = 0;
+        unsigned long long prepareAllocs = 0;
+        unsigned long long clearAllocs = 0;
+        AllocStats stats;
+        for (unsigned i = 0; i < LEVEL_ITERATIONS; i ++)
+        {
+            HiresTimer timer;
+            AllocCounter::BeginFrame();
+            core_.NewGame(i);
+            prepareLevel();
+            prepareTime += timer.GetUSec(true);
+            AllocCounter::EndFrame(stats);
+            prepareAllocs += stats.GetTotal();
+
+            AllocCounter::BeginFrame();
+            clearLevel();
+            clearTime += timer.GetUSec(false);
+            AllocCounter::EndFrame(stats);
+            clearAllocs += stats.GetTotal();
+        }
+        unsigned bricks = core_.GetBricks().Size();
+        report("prepareLevel", bricks, prepareTime, prepareAllocs, LEVEL_ITERATIONS);
+        report("clearLevel", bricks, clearTime, clearAllocs, LEVEL_ITERATIONS);
+        // stays flat over grid sizes while teardown is linear
+        report("clearLevel per brick", bricks, clearTime, clearAllocs, LEVEL_ITERATIONS * Max(bricks, 1U));
+    }
+
+    /// One frame of game logic with every brick of the level alive.
+    void benchUpdate()
+    {
+        core_.NewGame(0);
+        prepareLevel();
+        VariantMap eventData;
+        eventData[Update::P_TIMESTEP] = 1.0f / 60.0f;
+        measure("handleUpdate", core_.GetBricks().Size(), UPDATE_ITERATIONS, [&]() { handleUpdate(E_UPDATE, eventData); });
+        // game rules of one physics step
+        VariantMap stepData;
+        stepData[PhysicsPostStep::P_TIMESTEP] = 1.0f / 60.0f;
+        measure("physics step rules", core_.GetBricks().Size(), UPDATE_ITERATIONS, [&]()
+        {
+            handlePhysicsPreStep(E_PHYSICSPRESTEP, stepData);
+            handlePhysicsPostStep(E_PHYSICSPOSTSTEP, stepData);
+        });
+        clearLevel();
+    }
+
+    /// Reinsert all drawables into octree of current size, the way renderer updates octree every frame.
+    void updateOctree(Octree* octree)
+    {
+        // resized octree keeps its drawables in root octant until they move
+        scene_->MarkDirty();
+        FrameInfo frame;
+        frame.frameNumber_ = 1;
+        frame.timeStep_ = 0;
+        frame.camera_ = cameraNode_->GetComponent<Camera>();
+        octree->Update(frame);
+    }
+
+    /// Frustum culling of game camera at default and field sized octree, and one physics step, with every brick
+    /// of the level alive.
+    void benchScene()
+    {
+        core_.NewGame(0);
+        prepareLevel();
+        scene_->Update(0);
+        unsigned bricks = core_.GetBricks().Size();
+        Octree* octree = scene_->GetComponent<Octree>();
+        const Frustum& frustum = cameraNode_->GetComponent<Camera>()->GetFrustum();
+        PODVector<Drawable*> drawables;
+        FrustumOctreeQuery query(drawables, frustum, DRAWABLE_GEOMETRY);
+
+        octree->SetSize(BoundingBox(-DEFAULT_OCTREE_SIZE, DEFAULT_OCTREE_SIZE), DEFAULT_OCTREE_LEVELS);
+        updateOctree(octree);
+        measure("Octree query, default size", bricks, QUERY_ITERATIONS, [&]()
+        {
+            drawables.Clear();
+            octree->GetDrawables(query);
+        });
+        configureOctree(core_.GetConfig().brickWidth_);
+        updateOctree(octree);
+        measure("Octree query, field size", bricks, QUERY_ITERATIONS, [&]()
+        {
+            drawables.Clear();
+            octree->GetDrawables(query);
+        });
+
+        measure("PhysicsWorld::Update", bricks, UPDATE_ITERATIONS, [&]() { physicsWorld_->Update(1.0f / 60.0f); });
+        btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
+        printf("%-40s %8u %12d %12d\n", "physics objects, overlapping pairs", bricks, world->getNumCollisionObjects(),
+               world->getPairCache()->getNumOverlappingPairs());
+        clearLevel();
+    }
+
+    /// Collision events sent to component nodes the way PhysicsWorld sends them.
+    void benchEvents()
+    {
+        core_.NewGame(0);
+        prepareLevel();
+        // components of new nodes start during scene update
+        scene_->Update(0);
+        Node* brickFieldNode = brickField_->GetNode();
+        unsigned bricks = core_.GetBricks().Size();
+
+        // ball sits on the first brick for one physics step, so the field has a real contact with its child shape
+        const BrickStore& brickStore = core_.GetBricks();
+        RigidBody* ballBody = ballNode_->GetComponent<RigidBody>();
+        RigidBody* fieldBody = brickFieldNode->GetComponent<RigidBody>();
+        ballBody->SetPosition(Vector3(brickStore.GetX()[0], brickStore.GetY()[0], ballBody->GetPosition().z_));
+        ballBody->SetLinearVelocity(Vector3::ZERO);
+        physicsWorld_->Update(1.0f / 60.0f);
+        VectorBuffer contacts;
+        contacts.WriteVector3(Vector3(brickStore.GetX()[0], brickStore.GetY()[0], 0));
+        contacts.WriteVector3(Vector3::UP);
+        contacts.WriteFloat(0);
+        contacts.WriteFloat(1);
+        VariantMap eventData;
+        eventData[NodeCollision::P_TRIGGER] = false;
+        eventData[NodeCollision::P_CONTACTS] = contacts.GetBuffer();
+
+        eventData[NodeCollision::P_BODY] = fieldBody;
+        eventData[NodeCollision::P_OTHERNODE] = ballNode_.Get();
+        eventData[NodeCollision::P_OTHERBODY] = ballBody;
+        measure("BrickField collision (ball)", bricks, EVENT_ITERATIONS, [&]() { brickFieldNode->SendEvent(E_NODECOLLISION, eventData); });
+        // ball collision with brick plays hit sound
+        eventData[NodeCollision::P_BODY] = ballBody;
+        eventData[NodeCollision::P_OTHERNODE] = brickFieldNode;
+        eventData[NodeCollision::P_OTHERBODY] = fieldBody;
+        measure("Ball collision (brick), Ball::playSound", bricks, EVENT_ITERATIONS, [&]() { ballNode_->SendEvent(E_NODECOLLISION, eventData); });
+        clearLevel();
+    }
+
+    bool done_;
+};
+
+URHO3D_DEFINE_APPLICATION_MAIN(ComponentBenchmark)
@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Steps batches of headless games with a simple autopilot and reports environment steps per second.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "gamebatch.h"
+
+namespace
+{
+
+const float TIME_STEP = 1.0f / 60.0f;
+const unsigned STEPS = 2000;
+const unsigned SEED = 12345;
+
+// returns environment steps per second
+double runBatch(GameBatch& batch)
+{
+    std::vector<GameInput> actions(batch.GetCount());
+    batch.Reset(SEED);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned step = 0; step < STEPS; step ++)
+    {
+        // follow the ball with changing offset and launch it as soon as it rests on paddle
+        const float* ball = batch.GetBall();
+        for (unsigned i = 0; i < batch.GetCount(); i ++)
+        {
+            actions[i].movePaddle_ = true;
+            actions[i].paddleTargetX_ = ball[i * 4] + 0.04f * (int((step + i) / 600 % 5) - 2);
+            actions[i].launch_ = 0 == ball[i * 4 + 2] && 0 == ball[i * 4 + 3];
+        }
+        batch.Step(TIME_STEP, actions.data());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return double(batch.GetCount()) * STEPS / seconds;
+}
+
+}
+
+int main()
+{
+    // empty batch must construct, step and shut down without touching any row
+    {
+        GameBatch empty(0);
+        if (0 != empty.GetCount() || 1 != empty.GetThreadCount() || 0 != runBatch(empty))
+        {
+            printf("Empty batch check failed\n");
+            return 1;
+        }
+    }
+
+    static const unsigned counts[] = { 16, 256, 4096 };
+    printf("Batched game stepping, %u steps per batch\n", STEPS);
+    printf("%8s %8s %16s %16s\n", "games", "threads", "1 thread env/s", "pool env/s");
+    for (unsigned i = 0; i < sizeof(counts) / sizeof(counts[0]); i ++)
+    {
+        GameBatch single(counts[i], 1);
+        GameBatch pool(counts[i]);
+        double singleRate = runBatch(single);
+        double poolRate = runBatch(pool);
+        printf("%8u %8u %16.0f %16.0f\n", counts[i], pool.GetThreadCount(), singleRate, poolRate);
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Runs the engine independent game core headless with AutoPlayer and reports simulation steps per second, then
+// measures bonus movement while bonuses of the lower half of fields of several brick sizes fall at once.
+
+#include <chrono>
+#include <cstdio>
+
+#include "autoplay.h"
+#include "gamecore.h"
+
+namespace
+{
+
+const float TIME_STEP = 1.0f / 60.0f;
+const unsigned STEPS = 2000000;
+const unsigned SEED = 12345;
+const unsigned BONUS_STEPS = 120;
+// brick size multipliers, smaller bricks make bigger grids
+const float BRICK_SCALES[] = { 1.0f, 0.5f, 0.25f };
+
+// releases bonuses of the lower half of field like falling bonuses benchmark scenario of the game and reports time
+// of MoveBonuses() while they fall
+void benchFallingBonuses(float brickScale)
+{
+    GameCore core;
+    GameConfig config;
+    config.brickWidth_ *= brickScale;
+    config.brickHeight_ *= brickScale;
+    core.Configure(config);
+    core.NewGame(SEED);
+    const LevelLayout& layout = core.GetLayout();
+    float middleY = layout.shiftY_ - 0.5f * layout.countY_ * layout.brickHeight_;
+    const BrickStore& bricks = core.GetBricks();
+    for (unsigned i = 0; i < bricks.Size(); i ++)
+    {
+        if (bricks.GetY()[i] < middleY
+            && NULL_HANDLE != bricks.GetBonuses()[i])
+        {
+            core.HitBrick(bricks.GetHandle(i));
+        }
+    }
+    core.Update(TIME_STEP);
+    unsigned falling = core.GetBonuses().Size();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned step = 0; step < BONUS_STEPS; step ++)
+    {
+        core.MoveBonuses(TIME_STEP);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%8u %8u %12.0f\n", bricks.Size(), falling, seconds * 1e9 / BONUS_STEPS);
+}
+
+}
+
+int main()
+{
+    GameCore core;
+    core.NewGame(SEED);
+    GameInput input;
+    input.movePaddle_ = true;
+    unsigned ballHits = 0;
+    unsigned lostBalls = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned step = 0; step < STEPS; step ++)
+    {
+        // launch ball as soon as it rests on paddle
+        input.paddleTargetX_ = AutoPlayer::GetPaddleTarget(core);
+        input.launch_ = core.GetBall().onPaddle_;
+        core.Step(TIME_STEP, input);
+        const GameEvents& events = core.GetEvents();
+        ballHits += events.ballHits_;
+        lostBalls += false != events.ballLost_ ? 1 : 0;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("Game core, %u steps of %.4f s, brick kernel: %s\n", STEPS, TIME_STEP, BrickStore::GetKernelName());
+    printf("%.0f steps/s, %.1f ns/step, %.0f game seconds per second\n", STEPS / seconds, seconds * 1e9 / STEPS, STEPS * TIME_STEP / seconds);
+    printf("level %u, scores %u, ball hits %u, lost balls %u\n", core.GetLevel(), core.GetScores(), ballHits, lostBalls);
+
+    printf("Falling bonuses, %u steps\n", BONUS_STEPS);
+    printf("%8s %8s %12s\n", "bricks", "bonuses", "ns/step");
+    for (unsigned i = 0; i < sizeof(BRICK_SCALES) / sizeof(BRICK_SCALES[0]); i ++)
+    {
+        benchFallingBonuses(BRICK_SCALES[i]);
+    }
+    return 0;
+}
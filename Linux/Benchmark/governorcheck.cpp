@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Feeds QualityGovernor with the engine frame events of a frame limited game: frames which render well within
+// budget and then sleep in frame limiter up to the budget must keep the best tier, frames which render over
+// budget must step it down. Exit code is 0 when both hold, 1 otherwise.
+
+#include <cstdio>
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/GraphicsEvents.h>
+
+#include "qualitygovernor.h"
+
+namespace
+{
+
+// frame budget of best tier is 16.7 ms
+const unsigned FAST_RENDER_MSEC = 2;
+const unsigned SLOW_RENDER_MSEC = 17;
+const unsigned LIMITER_MSEC = 15;
+// governor evaluates every 90 frames and waits 3 windows after start, fast frames get twice that
+const unsigned FAST_FRAMES = 540;
+const unsigned SLOW_FRAMES = 360;
+
+// one frame as Engine::RunFrame sends it: render work, end of rendering, frame limiter sleep, end of frame
+void runFrame(QualityGovernor* governor, unsigned renderMsec, unsigned limiterMsec)
+{
+    VariantMap eventData;
+    governor->SendEvent(E_BEGINFRAME, eventData);
+    Time::Sleep(renderMsec);
+    governor->SendEvent(E_ENDRENDERING, eventData);
+    Time::Sleep(limiterMsec);
+    governor->SendEvent(E_ENDFRAME, eventData);
+}
+
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    SharedPtr<QualityGovernor> governor(new QualityGovernor(context));
+    governor->Start(0, nullptr);
+
+    for (unsigned i = 0; i < FAST_FRAMES; i ++)
+    {
+        runFrame(governor, FAST_RENDER_MSEC, LIMITER_MSEC);
+    }
+    if (0 != governor->GetTier())
+    {
+        printf("Fast frames with limiter sleep stepped quality down to tier %u\n", governor->GetTier());
+        return 1;
+    }
+    for (unsigned i = 0; i < SLOW_FRAMES; i ++)
+    {
+        runFrame(governor, SLOW_RENDER_MSEC, 0);
+    }
+    if (1 != governor->GetTier())
+    {
+        printf("Slow frames left quality at tier %u instead of stepping down to tier 1\n", governor->GetTier());
+        return 1;
+    }
+    printf("Quality governor keeps tier on fast frames and steps down on slow ones\n");
+    return 0;
+}
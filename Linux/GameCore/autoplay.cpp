@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <cmath>
+
+#include "autoplay.h"
+
+namespace
+{
+// value of extend paddle bonus compared to scores
+const unsigned EXTEND_VALUE = 300;
+// largest share of paddle half width used to aim the bounce
+const float MAX_AIM = 0.8f;
+// time reserve for getting back to the ball after bonus
+const float SAFETY_TIME = 0.1f;
+}
+
+float AutoPlayer::fold(float x, float left, float right)
+{
+    float width = right - left;
+    if (width <= 0)
+    {
+        return left;
+    }
+    float offset = std::fmod(x - left, 2 * width);
+    if (offset < 0)
+    {
+        offset += 2 * width;
+    }
+    return offset <= width ? left + offset : left + 2 * width - offset;
+}
+
+float AutoPlayer::PredictCrossing(const BallState& ball, float radius, float lineY, float& time)
+{
+    if (0 == ball.velocityY_)
+    {
+        time = 0;
+        return ball.x_;
+    }
+    if (ball.velocityY_ < 0)
+    {
+        time = (ball.y_ - lineY) / -ball.velocityY_;
+    }
+    else
+    {
+        // up to the ceiling and back down
+        float top = 0.5f * FIELD_HEIGHT - radius;
+        time = ((top - ball.y_) + (top - lineY)) / ball.velocityY_;
+    }
+    if (time < 0)
+    {
+        time = 0;
+    }
+    return fold(ball.x_ + ball.velocityX_ * time, -0.5f * FIELD_WIDTH + radius, 0.5f * FIELD_WIDTH - radius);
+}
+
+unsigned AutoPlayer::getBonusValue(const GameCore& core, const BonusState& bonus)
+{
+    switch (bonus.type_)
+    {
+        case BONUS_SHRINKPADDLE:
+            return 0;
+        case BONUS_EXTENDPADDLE:
+            return core.GetPaddle().scaleLevel_ < PADDLE_SCALE_MAX ? EXTEND_VALUE : 0;
+        default:
+            return BONUS_SCORES[bonus.type_];
+    }
+}
+
+float AutoPlayer::GetPaddleTarget(const GameCore& core)
+{
+    const GameConfig& config = core.GetConfig();
+    const BallState& ball = core.GetBall();
+    const PaddleState& paddle = core.GetPaddle();
+    float halfWidth = config.paddleHalfWidth_ * paddle.scale_;
+    float lineY = config.paddleY_ + config.paddleHalfHeight_ + config.ballRadius_;
+
+    float ballTime = 0;
+    float crossing = paddle.x_;
+    if (false == ball.onPaddle_)
+    {
+        crossing = PredictCrossing(ball, config.ballRadius_, lineY, ballTime);
+    }
+    // hit the ball with paddle part which sends it towards the nearest brick, paddle bounce turns hit offset into
+    // horizontal speed, see GameCore::Step()
+    const BrickStore& bricks = core.GetBricks();
+    const float* x = bricks.GetX();
+    const float* y = bricks.GetY();
+    float bestDistance = -1;
+    float slope = 0;
+    for (unsigned i = 0; i < bricks.Size(); i ++)
+    {
+        float dx = x[i] - crossing;
+        float dy = y[i] - lineY;
+        float distance = dx * dx + dy * dy;
+        if (dy > 0
+            && (bestDistance < 0 || distance < bestDistance))
+        {
+            bestDistance = distance;
+            slope = dx / dy;
+        }
+    }
+    float speed = std::sqrt(ball.velocityX_ * ball.velocityX_ + ball.velocityY_ * ball.velocityY_);
+    float offset = 0;
+    if (speed > 0)
+    {
+        offset = slope * std::fabs(ball.velocityY_) / (PADDLE_DEFLECTION * speed);
+        offset = offset < -MAX_AIM ? -MAX_AIM : (offset > MAX_AIM ? MAX_AIM : offset);
+    }
+    float ballTarget = crossing - offset * halfWidth;
+    if (false != ball.onPaddle_)
+    {
+        return ballTarget;
+    }
+
+    // the most valuable bonus which can be caught without missing the ball
+    float catchY = config.paddleY_ + config.paddleHalfHeight_ + config.bonusHalfHeight_;
+    float reach = halfWidth + config.bonusHalfWidth_;
+    unsigned bestValue = 0;
+    float bestX = ballTarget;
+    const HandleTable<BonusState>& bonuses = core.GetBonuses();
+    for (unsigned i = 0; i < bonuses.Size(); i ++)
+    {
+        const BonusState& bonus = bonuses[i];
+        unsigned value = getBonusValue(core, bonus);
+        if (false == bonus.active_
+            || value <= bestValue)
+        {
+            continue;
+        }
+        float bonusTime = (bonus.y_ - catchY) / BONUS_SPEED;
+        float toBonus = std::fabs(bonus.x_ - paddle.x_) - reach;
+        float bonusToBall = std::fabs(crossing - bonus.x_) - halfWidth;
+        // bonus is caught first and there is still time to get back to the ball
+        if (bonusTime >= 0
+            && toBonus <= PADDLE_SPEED * bonusTime
+            && bonusTime + bonusToBall / PADDLE_SPEED + SAFETY_TIME <= ballTime)
+        {
+            bestValue = value;
+            bestX = bonus.x_;
+        }
+    }
+    return bestX;
+}
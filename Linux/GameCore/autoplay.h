@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "gamecore.h"
+
+/// Player that never loses: predicts where the ball crosses paddle line, reflecting it off field borders, and moves
+/// paddle there, aiming the bounce towards remaining bricks. When there is time before the ball comes down it catches
+/// the most valuable falling bonus on the way. Costs a few dozen operations per call, so it runs every fixed step.
+class AutoPlayer
+{
+public:
+    /// Return paddle target for current game state.
+    static float GetPaddleTarget(const GameCore& core);
+    /// Return x where ball center reaches height lineY, ball bounces off side borders and ceiling, bricks are ignored.
+    /// Time to reach the line is returned in time.
+    static float PredictCrossing(const BallState& ball, float radius, float lineY, float& time);
+
+private:
+    /// Return x of ball moving without borders folded into range [left, right].
+    static float fold(float x, float left, float right);
+    /// Return value of catching bonus, zero for unwanted bonuses.
+    static unsigned getBonusValue(const GameCore& core, const BonusState& bonus);
+};
@@ -0,0 +1,257 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <cstdint>
+#include <new>
+
+#include "gamebatch.h"
+
+GameBatch::GameBatch(unsigned count, unsigned threads, const GameConfig& config) :
+    count_(count),
+    games_(new GameCore[count]),
+    brickWords_(0),
+    timeStep_(0),
+    actions_(nullptr),
+    rangeStorage_(nullptr),
+    ranges_(nullptr),
+    pass_(0),
+    busyWorkers_(0),
+    exit_(false)
+{
+    for (unsigned i = 0; i < count_; i ++)
+    {
+        games_[i].Configure(config);
+    }
+    // grid size depends on config only, so one game tells it for all
+    GameCore probe;
+    probe.Configure(config);
+    probe.NewGame(0);
+    const LevelLayout& layout = probe.GetLayout();
+    brickWords_ = (unsigned(layout.countX_ * layout.countY_) + 31) / 32;
+
+    ball_.resize(count_ * 4);
+    paddle_.resize(count_ * 2);
+    bricks_.resize(count_ * brickWords_);
+    bonuses_.resize(count_ * BATCH_MAX_BONUSES * 3);
+    bonusCounts_.resize(count_);
+    rewards_.resize(count_);
+    scores_.resize(count_);
+    ballLost_.resize(count_);
+
+    if (0 == threads)
+    {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads > count_)
+    {
+        threads = count_;
+    }
+    if (0 == threads)
+    {
+        threads = 1;
+    }
+    // new of C++11 doesn't honour alignment over that of fundamental types, so ranges are placed by hand
+    rangeStorage_ = new char[threads * sizeof(Range) + alignof(Range) - 1];
+    uintptr_t address = reinterpret_cast<uintptr_t>(rangeStorage_);
+    ranges_ = reinterpret_cast<Range*>((address + alignof(Range) - 1) & ~uintptr_t(alignof(Range) - 1));
+    for (unsigned i = 0; i < threads; i ++)
+    {
+        new (ranges_ + i) Range();
+    }
+    // calling thread works as worker 0
+    for (unsigned i = 1; i < threads; i ++)
+    {
+        workers_.push_back(std::thread(&GameBatch::workerLoop, this, i));
+    }
+}
+
+GameBatch::~GameBatch()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        exit_ = true;
+    }
+    startCondition_.notify_all();
+    for (size_t i = 0; i < workers_.size(); i ++)
+    {
+        workers_[i].join();
+    }
+    for (unsigned i = 0; i < GetThreadCount(); i ++)
+    {
+        ranges_[i].~Range();
+    }
+    delete[] rangeStorage_;
+    delete[] games_;
+}
+
+void GameBatch::Reset(unsigned seed)
+{
+    for (unsigned i = 0; i < count_; i ++)
+    {
+        games_[i].NewGame(seed + i);
+        scores_[i] = 0;
+        writeObservations(i);
+    }
+}
+
+void GameBatch::Step(float timeStep, const GameInput* actions)
+{
+    if (0 == count_)
+    {
+        return;
+    }
+    timeStep_ = timeStep;
+    actions_ = actions;
+    run();
+}
+
+void GameBatch::run()
+{
+    unsigned threads = GetThreadCount();
+    for (unsigned i = 0; i < threads; i ++)
+    {
+        ranges_[i].next_.store(count_ * i / threads, std::memory_order_relaxed);
+        ranges_[i].end_ = count_ * (i + 1) / threads;
+    }
+    if (false == workers_.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pass_ ++;
+            busyWorkers_ = unsigned(workers_.size());
+        }
+        startCondition_.notify_all();
+    }
+    work(0);
+    if (false == workers_.empty())
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (0 != busyWorkers_)
+        {
+            doneCondition_.wait(lock);
+        }
+    }
+}
+
+void GameBatch::work(unsigned worker)
+{
+    unsigned threads = GetThreadCount();
+    // own range first, it holds the same instances every step, then help others
+    for (unsigned i = 0; i < threads; i ++)
+    {
+        Range& range = ranges_[(worker + i) % threads];
+        for (;;)
+        {
+            unsigned index = range.next_.fetch_add(1, std::memory_order_relaxed);
+            if (index >= range.end_)
+            {
+                break;
+            }
+            games_[index].Step(timeStep_, actions_[index]);
+            writeObservations(index);
+        }
+    }
+}
+
+void GameBatch::workerLoop(unsigned worker)
+{
+    unsigned donePass = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (false == exit_
+                && donePass == pass_)
+            {
+                startCondition_.wait(lock);
+            }
+            if (false != exit_)
+            {
+                return;
+            }
+            donePass = pass_;
+        }
+        work(worker);
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            last = 0 == -- busyWorkers_;
+        }
+        if (false != last)
+        {
+            doneCondition_.notify_one();
+        }
+    }
+}
+
+void GameBatch::writeObservations(unsigned index)
+{
+    const GameCore& game = games_[index];
+    const BallState& ball = game.GetBall();
+    float* ballRow = &ball_[index * 4];
+    ballRow[0] = ball.x_;
+    ballRow[1] = ball.y_;
+    ballRow[2] = ball.velocityX_;
+    ballRow[3] = ball.velocityY_;
+    const PaddleState& paddle = game.GetPaddle();
+    paddle_[index * 2] = paddle.x_;
+    paddle_[index * 2 + 1] = paddle.scale_;
+
+    unsigned* brickRow = &bricks_[index * brickWords_];
+    for (unsigned i = 0; i < brickWords_; i ++)
+    {
+        brickRow[i] = 0;
+    }
+    const LevelLayout& layout = game.GetLayout();
+    unsigned cells = unsigned(layout.countX_ * layout.countY_);
+    for (unsigned i = 0; i < cells; i ++)
+    {
+        if (false != game.HasBrick(i))
+        {
+            brickRow[i / 32] |= 1u << (i % 32);
+        }
+    }
+
+    float* bonusRow = &bonuses_[index * BATCH_MAX_BONUSES * 3];
+    unsigned bonusCount = 0;
+    const HandleTable<BonusState>& bonuses = game.GetBonuses();
+    for (unsigned i = 0; i < bonuses.Size() && bonusCount < BATCH_MAX_BONUSES; i ++)
+    {
+        const BonusState& bonus = bonuses[i];
+        if (false != bonus.active_)
+        {
+            bonusRow[bonusCount * 3] = bonus.x_;
+            bonusRow[bonusCount * 3 + 1] = bonus.y_;
+            bonusRow[bonusCount * 3 + 2] = float(bonus.type_);
+            bonusCount ++;
+        }
+    }
+    for (unsigned i = bonusCount * 3; i < BATCH_MAX_BONUSES * 3; i ++)
+    {
+        bonusRow[i] = 0;
+    }
+    bonusCounts_[index] = (unsigned char)bonusCount;
+
+    rewards_[index] = game.GetScores() - scores_[index];
+    scores_[index] = game.GetScores();
+    ballLost_[index] = false != game.GetEvents().ballLost_ ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gamecore.h"
+
+/// Number of falling bonuses reported per instance.
+const unsigned BATCH_MAX_BONUSES = 8;
+
+/// Many independent games stepped in lockstep for bots and training. Observations are packed in flat arrays,
+/// instance i owns rows starting at i * row size. Instances are spread over a pool of worker threads, each worker
+/// first steps its own range of instances, then steals remaining instances of slower workers.
+class GameBatch
+{
+public:
+    /// Create instances sharing one config. Zero threads means one per hardware thread, calling thread is one of them.
+    /// Zero count gives an empty batch whose steps do nothing and whose observation rows are empty.
+    GameBatch(unsigned count, unsigned threads = 0, const GameConfig& config = GameConfig());
+    ~GameBatch();
+
+    /// Start new games, instance i gets seed + i. Observations are updated.
+    void Reset(unsigned seed);
+    /// Step every instance with its action from array of GetCount() inputs and update observations.
+    void Step(float timeStep, const GameInput* actions);
+
+    /// Return number of instances.
+    unsigned GetCount() const { return count_; }
+    /// Return number of threads stepping instances.
+    unsigned GetThreadCount() const { return unsigned(workers_.size()) + 1; }
+    /// Return instance, valid until batch is destroyed.
+    const GameCore& GetGame(unsigned index) const { return games_[index]; }
+
+    /// Return ball rows: x, y, velocity x, velocity y.
+    const float* GetBall() const { return ball_.data(); }
+    /// Return paddle rows: x, scale.
+    const float* GetPaddle() const { return paddle_.data(); }
+    /// Return brick occupancy rows of GetBrickWords() words, bit of grid cell j * countX + i is set while brick exists.
+    const unsigned* GetBricks() const { return bricks_.data(); }
+    unsigned GetBrickWords() const { return brickWords_; }
+    /// Return falling bonus rows of BATCH_MAX_BONUSES entries: x, y, type. Unused entries are zero.
+    const float* GetBonuses() const { return bonuses_.data(); }
+    /// Return number of falling bonuses reported per instance.
+    const unsigned char* GetBonusCounts() const { return bonusCounts_.data(); }
+    /// Return scores gained during last step.
+    const unsigned* GetRewards() const { return rewards_.data(); }
+    /// Return flags of instances which lost ball during last step.
+    const unsigned char* GetBallLost() const { return ballLost_.data(); }
+
+private:
+    /// Range of instances owned by a worker, consumed from front by owner and thieves alike. Aligned to cache line,
+    /// so ranges of different workers never share one.
+    struct alignas(64) Range
+    {
+        std::atomic<unsigned> next_;
+        unsigned end_;
+    };
+
+    GameBatch(const GameBatch&);
+    GameBatch& operator =(const GameBatch&);
+
+    /// Split instances into worker ranges and run pass on all threads.
+    void run();
+    /// Step instances of own range, then steal from other ranges.
+    void work(unsigned worker);
+    /// Thread function of pool workers.
+    void workerLoop(unsigned worker);
+    /// Write observations of instance and its scores gained since previous call.
+    void writeObservations(unsigned index);
+
+    unsigned count_;
+    GameCore* games_;
+    unsigned brickWords_;
+    std::vector<float> ball_;
+    std::vector<float> paddle_;
+    std::vector<unsigned> bricks_;
+    std::vector<float> bonuses_;
+    std::vector<unsigned char> bonusCounts_;
+    std::vector<unsigned> rewards_;
+    std::vector<unsigned> scores_;
+    std::vector<unsigned char> ballLost_;
+
+    // current pass
+    float timeStep_;
+    const GameInput* actions_;
+    // worker pool
+    std::vector<std::thread> workers_;
+    /// Storage of ranges, allocated with room to align them by hand.
+    char* rangeStorage_;
+    Range* ranges_;
+    std::mutex mutex_;
+    std::condition_variable startCondition_;
+    std::condition_variable doneCondition_;
+    unsigned pass_;
+    unsigned busyWorkers_;
+    bool exit_;
+};
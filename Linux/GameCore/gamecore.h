@@ -0,0 +1,245 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "brickstore.h"
+#include "gamedefs.h"
+#include "handletable.h"
+#include "levelarena.h"
+
+/// Sizes of game objects, engine adapters measure them from models.
+struct GameConfig
+{
+    GameConfig();
+
+    float brickWidth_;
+    float brickHeight_;
+    /// Half width of paddle at scale 1.
+    float paddleHalfWidth_;
+    float paddleHalfHeight_;
+    float paddleY_;
+    float ballRadius_;
+    /// Ball height over paddle center while ball rests on paddle.
+    float ballOffsetY_;
+    float bonusHalfWidth_;
+    float bonusHalfHeight_;
+};
+
+/// Brick grid of current level.
+struct LevelLayout
+{
+    int countX_, countY_;
+    float brickWidth_, brickHeight_;
+    float shiftX_, shiftY_;
+};
+
+/// Bonus of current level. Bonus waits inside its brick until brick is hit, then falls down until caught or lost.
+struct BonusState
+{
+    float x_, y_;
+    unsigned char type_;
+    bool active_;
+    /// Falls at half speed during next step, set when bonus lies on top of another one.
+    bool slowed_;
+};
+
+struct PaddleState
+{
+    float x_;
+    float targetX_;
+    /// Paddle size step, 0 to PADDLE_SCALE_MAX.
+    int scaleLevel_;
+    /// Current x-scale, animated towards scale of scaleLevel_.
+    float scale_;
+};
+
+struct BallState
+{
+    float x_, y_;
+    float velocityX_, velocityY_;
+    bool onPaddle_;
+};
+
+/// Player input of one step.
+struct GameInput
+{
+    GameInput() : paddleTargetX_(0), movePaddle_(false), launch_(false), speed_(SPEED_NORMAL) { }
+
+    float paddleTargetX_;
+    bool movePaddle_;
+    /// Launch ball if it rests on paddle.
+    bool launch_;
+    float speed_;
+};
+
+/// What has happened since last ClearEvents(), engine adapters mirror it in scene. Arrays are valid until next update.
+struct GameEvents
+{
+    /// Slots and new scales of shrinking bricks.
+    const unsigned* scaledBrickSlots_;
+    const float* brickScales_;
+    unsigned scaledBrickCount_;
+    /// Bricks removed after collapse, only slots of these handles are meaningful any more.
+    const EntityHandle* collapsedBricks_;
+    unsigned collapsedBrickCount_;
+    /// Bonuses which started falling.
+    const EntityHandle* activatedBonuses_;
+    unsigned activatedBonusCount_;
+    /// Bonuses which left the game: caught, fallen out of field or cleared after lost ball.
+    const EntityHandle* removedBonuses_;
+    unsigned removedBonusCount_;
+    /// Ball bounces off bricks and paddle, counted by Step() only.
+    unsigned ballHits_;
+    bool ballLost_;
+    /// New level has been prepared, all handles of previous level are stale.
+    bool levelCompleted_;
+};
+
+/// Runs independent jobs of a step, possibly in parallel. Game core splits entity updates of large levels into jobs
+/// and merges their results in job order, so results don't depend on how jobs are scheduled.
+class GameJobRunner
+{
+public:
+    virtual ~GameJobRunner() { }
+    /// Call job(data, index) for every index in [0, count) and return when all calls are done.
+    virtual void Run(unsigned count, void (*job)(void* data, unsigned index), void* data) = 0;
+};
+
+/// Engine independent arkanoid rules: brick collapse, bonus drop and pickup, paddle motion and scaling, scoring,
+/// ball reset and level progression. In the game ball flight is simulated by physics engine, which reports contacts
+/// through HitBrick() and LoseBall(), bonuses fall by MoveBonuses() without physics bodies, and Update() applies the
+/// rules. Step() adds own simple kinematics of ball, so the whole game runs without engine.
+class GameCore
+{
+public:
+    GameCore();
+
+    /// Set object sizes, takes effect from next level.
+    void Configure(const GameConfig& config) { config_ = config; }
+    /// Set runner of parallel jobs for updates of large levels, null runs everything on calling thread.
+    void SetJobRunner(GameJobRunner* runner) { jobRunner_ = runner; }
+    /// Start new game, seed defines all levels.
+    void NewGame(unsigned seed);
+    /// Generate new brick field with bonuses and put ball on paddle.
+    void PrepareLevel();
+    /// Advance whole game by time step: input, ball and bonus motion with collisions, then rules.
+    /// Events are cleared at the beginning of the step.
+    void Step(float timeStep, const GameInput& input);
+    /// Advance rules only, ball and bonus motion is simulated outside. Call ClearEvents() after handling events.
+    void Update(float timeStep);
+    void ClearEvents();
+
+    void SetPaddleTarget(float x) { paddle_.targetX_ = x; }
+    /// Launch ball resting on paddle.
+    void LaunchBall();
+    /// Ball has hit brick.
+    void HitBrick(EntityHandle brick) { bricks_.Hit(brick); }
+    /// Paddle has caught falling bonus.
+    void CatchBonus(EntityHandle bonus);
+    /// Move falling bonuses down, slow down those lying on top of another one, catch those overlapping paddle and
+    /// drop those out of field. Overlaps are box tests, so bonuses never need physics bodies.
+    void MoveBonuses(float timeStep);
+    /// Set ball position and velocity simulated outside, so observers like AutoPlayer see it.
+    void SetBall(float x, float y, float velocityX, float velocityY);
+    /// Bonus has fallen out of field.
+    void DropBonus(EntityHandle bonus);
+    /// Ball has left the field: ball goes back on paddle, falling bonuses are removed, paddle size is reset.
+    void LoseBall();
+
+    /// Return whether ball at this height has left the field.
+    static bool IsBallOut(float y) { return y < -0.5f * FIELD_HEIGHT; }
+    /// Return whether bonus at this height has left the field.
+    static bool IsBonusOut(float y) { return y < -0.75f * FIELD_HEIGHT; }
+    /// Keep ball speed constant and make sure it always moves vertically, so it can't bounce horizontally forever.
+    static void ClampBallVelocity(float& velocityX, float& velocityY, float speed);
+    /// Return x-scale of paddle for size step.
+    static float GetPaddleScale(int scaleLevel) { return 0.75f + 0.25f * scaleLevel; }
+
+    const GameConfig& GetConfig() const { return config_; }
+    const LevelLayout& GetLayout() const { return layout_; }
+    const BrickStore& GetBricks() const { return bricks_; }
+    /// Return whether brick exists in grid cell j * countX + i.
+    bool HasBrick(unsigned cell) const { return bricks_.IsValid(cells_[cell]); }
+    const HandleTable<BonusState>& GetBonuses() const { return bonuses_; }
+    /// Return bonus by handle or null for removed bonus.
+    const BonusState* GetBonus(EntityHandle bonus) const { return bonuses_.Get(bonus); }
+    const PaddleState& GetPaddle() const { return paddle_; }
+    const BallState& GetBall() const { return ball_; }
+    const GameEvents& GetEvents() const { return events_; }
+    unsigned GetScores() const { return scores_; }
+    unsigned GetLevel() const { return level_; }
+
+private:
+    GameCore(const GameCore&);
+    GameCore& operator =(const GameCore&);
+
+    /// Return random number in [min, max).
+    int random(int min, int max);
+    /// Move paddle towards target and animate its scale.
+    void updatePaddle(float timeStep);
+    /// Move ball with bounces off field borders, bricks and paddle.
+    void moveBall(float timeStep, float speed);
+    /// Collect brick results, in parallel jobs over ranges of whole grid rows for large levels.
+    void updateBricks(float timeStep, BrickUpdateResult& result);
+    /// Return fall speed of bonus for next step and reset its slowdown.
+    float takeBonusSpeed(EntityHandle bonus);
+    /// Move bonuses in [begin, end) down.
+    void fallBonuses(float timeStep, unsigned begin, unsigned end);
+    /// Collect falling bonuses sorted by x for stacking checks.
+    void sortActiveBonuses();
+    /// Mark bonuses at positions [begin, end) of sorted falling bonuses lying on top of another one as slowed.
+    void stackBonuses(unsigned begin, unsigned end);
+    /// Run job over consecutive ranges of count items, in parallel when runner is set.
+    void runRanges(unsigned count, unsigned rangeSize, void (*job)(void* data, unsigned index));
+    static void updateBricksJob(void* data, unsigned index);
+    static void fallBonusesJob(void* data, unsigned index);
+    static void stackBonusesJob(void* data, unsigned index);
+    /// Remove bonus from game and report it.
+    void removeBonus(EntityHandle bonus);
+
+    GameConfig config_;
+    unsigned randomState_;
+    LevelArena arena_;
+    LevelLayout layout_;
+    BrickStore bricks_;
+    HandleTable<BonusState> bonuses_;
+    /// Spatial index of bricks, brick handle per grid cell.
+    EntityHandle* cells_;
+    /// Grid cell of brick by brick slot.
+    unsigned* brickCells_;
+    EntityHandle* activatedBonuses_;
+    EntityHandle* removedBonuses_;
+    /// Dense indices of falling bonuses sorted by x, rebuilt by every MoveBonuses().
+    unsigned* activeBonuses_;
+    unsigned activeBonusCount_;
+    GameJobRunner* jobRunner_;
+    /// Results of brick ranges, and state of jobs running now.
+    BrickRangeResult* brickRanges_;
+    unsigned jobRangeSize_;
+    float jobTimeStep_;
+    PaddleState paddle_;
+    BallState ball_;
+    GameEvents events_;
+    unsigned scores_;
+    unsigned level_;
+};
@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <chrono>
+
+#include "autoplay.h"
+#include "gamesimulation.h"
+
+namespace
+{
+// steps simulation is allowed to fall behind before it stops catching up, e.g. after suspended application
+const unsigned MAX_LAG_STEPS = 5;
+}
+
+GameSnapshot::GameSnapshot() :
+    step_(0),
+    level_(0),
+    scores_(0)
+{
+    ball_ = BallState();
+    paddle_ = PaddleState();
+}
+
+GameSimulation::GameSimulation(GameCore& core, float timeStep) :
+    core_(core),
+    timeStep_(timeStep),
+    running_(false),
+    autoplay_(false),
+    paused_(false),
+    front_(0)
+{
+    input_ = GameInput();
+    input_.speed_ = SPEED_NORMAL;
+}
+
+GameSimulation::~GameSimulation()
+{
+    Stop();
+}
+
+void GameSimulation::Start()
+{
+    if (false != running_)
+    {
+        return;
+    }
+    captureLevel();
+    publish();
+    running_ = true;
+    thread_ = std::thread(&GameSimulation::threadLoop, this);
+}
+
+void GameSimulation::Stop()
+{
+    running_ = false;
+    if (false != thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+void GameSimulation::SetInput(const GameInput& input)
+{
+    std::lock_guard<std::mutex> lock(inputMutex_);
+    bool launch = input_.launch_;
+    input_ = input;
+    input_.launch_ = launch || input.launch_;
+}
+
+const GameSnapshot& GameSimulation::LockSnapshot()
+{
+    snapshotMutex_.lock();
+    return buffers_[front_];
+}
+
+void GameSimulation::UnlockSnapshot()
+{
+    snapshotMutex_.unlock();
+}
+
+void GameSimulation::threadLoop()
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration stepDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(timeStep_));
+    Clock::time_point next = Clock::now();
+    while (false != running_)
+    {
+        if (false == paused_)
+        {
+            step();
+            publish();
+        }
+        next += stepDuration;
+        Clock::time_point now = Clock::now();
+        if (now - next > stepDuration * MAX_LAG_STEPS)
+        {
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void GameSimulation::step()
+{
+    std::lock_guard<std::mutex> coreLock(coreMutex_);
+    GameInput input;
+    {
+        std::lock_guard<std::mutex> lock(inputMutex_);
+        input = input_;
+        input_.launch_ = false;
+    }
+    if (false != autoplay_)
+    {
+        input.paddleTargetX_ = AutoPlayer::GetPaddleTarget(core_);
+        input.movePaddle_ = true;
+        input.launch_ = core_.GetBall().onPaddle_;
+    }
+    core_.Step(timeStep_, input);
+    const GameEvents& events = core_.GetEvents();
+    if (false != events.levelCompleted_)
+    {
+        captureLevel();
+        return;
+    }
+    for (unsigned i = 0; i < events.scaledBrickCount_; i ++)
+    {
+        brickScales_[events.scaledBrickSlots_[i]] = events.brickScales_[i];
+    }
+    for (unsigned i = 0; i < events.collapsedBrickCount_; i ++)
+    {
+        brickScales_[events.collapsedBricks_[i].slot_] = 0;
+    }
+}
+
+void GameSimulation::captureLevel()
+{
+    const LevelLayout& layout = core_.GetLayout();
+    brickScales_.assign(unsigned(layout.countX_ * layout.countY_), 0.0f);
+    const BrickStore& bricks = core_.GetBricks();
+    for (unsigned i = 0; i < bricks.Size(); i ++)
+    {
+        brickScales_[bricks.GetSlot(i)] = 1.0f;
+    }
+}
+
+void GameSimulation::publish()
+{
+    // back buffer isn't touched by reader, so it is written without lock
+    GameSnapshot& snapshot = buffers_[1 - front_];
+    {
+        std::lock_guard<std::mutex> coreLock(coreMutex_);
+        snapshot.step_ = buffers_[front_].step_ + 1;
+        snapshot.level_ = core_.GetLevel();
+        snapshot.scores_ = core_.GetScores();
+        snapshot.ball_ = core_.GetBall();
+        snapshot.paddle_ = core_.GetPaddle();
+        snapshot.brickScales_ = brickScales_;
+        BonusState removed = BonusState();
+        removed.type_ = BONUS_NONE;
+        snapshot.bonuses_.assign(brickScales_.size(), removed);
+        const HandleTable<BonusState>& bonuses = core_.GetBonuses();
+        for (unsigned i = 0; i < bonuses.Size(); i ++)
+        {
+            snapshot.bonuses_[bonuses.GetHandle(i).slot_] = bonuses[i];
+        }
+    }
+    std::lock_guard<std::mutex> lock(snapshotMutex_);
+    front_ = 1 - front_;
+}
@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gamecore.h"
+
+/// State of game needed for rendering, taken after a simulation step.
+struct GameSnapshot
+{
+    GameSnapshot();
+
+    /// Steps done since simulation start.
+    unsigned step_;
+    unsigned level_;
+    unsigned scores_;
+    BallState ball_;
+    PaddleState paddle_;
+    /// Brick scales by handle slot, 1 for whole bricks, 0 for removed ones.
+    std::vector<float> brickScales_;
+    /// Bonuses by handle slot, removed bonuses have BONUS_NONE type.
+    std::vector<BonusState> bonuses_;
+};
+
+/// Steps game core at fixed rate on its own thread and publishes snapshot after every step into one of two buffers,
+/// while reader holds the other one. Reader locks the latest snapshot for as long as it copies from it, so writer
+/// never waits for more than that.
+class GameSimulation
+{
+public:
+    GameSimulation(GameCore& core, float timeStep);
+    ~GameSimulation();
+
+    /// Start stepping thread, core should have its game started.
+    void Start();
+    /// Stop and join stepping thread.
+    void Stop();
+    /// Set input of next steps, launch request waits for a step which takes it.
+    void SetInput(const GameInput& input);
+    /// Let AutoPlayer drive paddle instead of input.
+    void SetAutoplay(bool enable) { autoplay_ = enable; }
+    /// Stop or continue stepping.
+    void SetPaused(bool paused) { paused_ = paused; }
+    /// Lock latest snapshot for reading.
+    const GameSnapshot& LockSnapshot();
+    void UnlockSnapshot();
+    /// Lock game core, nothing is stepped until it is unlocked.
+    void LockCore() { coreMutex_.lock(); }
+    void UnlockCore() { coreMutex_.unlock(); }
+    /// Return time step of simulation.
+    float GetTimeStep() const { return timeStep_; }
+
+private:
+    GameSimulation(const GameSimulation&);
+    GameSimulation& operator =(const GameSimulation&);
+
+    void threadLoop();
+    void step();
+    /// Reset brick scales to bricks of current level.
+    void captureLevel();
+    void publish();
+
+    GameCore& core_;
+    float timeStep_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> autoplay_;
+    std::atomic<bool> paused_;
+    /// Held by thread during a step.
+    std::mutex coreMutex_;
+    std::mutex inputMutex_;
+    GameInput input_;
+    std::mutex snapshotMutex_;
+    GameSnapshot buffers_[2];
+    unsigned front_;
+    /// Brick scales of the latest step, they change by core events only.
+    std::vector<float> brickScales_;
+};
@@ -0,0 +1,235 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "levelarena.h"
+
+/// Reference to an entity of HandleTable. Generation tells apart handles of removed entities whose slot was reused.
+struct EntityHandle
+{
+    unsigned slot_;
+    unsigned generation_;
+
+    bool operator ==(const EntityHandle& rhs) const { return slot_ == rhs.slot_ && generation_ == rhs.generation_; }
+    bool operator !=(const EntityHandle& rhs) const { return !(*this == rhs); }
+};
+
+/// Handle that never refers to an entity.
+const EntityHandle NULL_HANDLE = { 0xffffffff, 0 };
+
+/// Generational handle bookkeeping for dense storage kept by the owner. Entities are packed in [0, Size()), removal
+/// moves the last entity into the freed place, so iteration touches live entities only. Slot of a live entity never
+/// changes and may be used to index owner side per-entity data. Memory is allocated from a level arena and is
+/// forgotten by Clear().
+class HandleMap
+{
+public:
+    HandleMap() :
+        denseSlots_(nullptr),
+        slots_(nullptr),
+        size_(0),
+        capacity_(0),
+        freeSlot_(NO_SLOT),
+        usedSlots_(0),
+        nextGeneration_(0)
+    {
+    }
+
+    /// Set up bookkeeping for up to capacity entities.
+    void Initialize(LevelArena& arena, unsigned capacity)
+    {
+        denseSlots_ = arena.AllocateArray<unsigned>(capacity);
+        slots_ = arena.AllocateArray<Slot>(capacity);
+        size_ = 0;
+        capacity_ = capacity;
+        freeSlot_ = NO_SLOT;
+        usedSlots_ = 0;
+    }
+    /// Forget all entities. Generations keep growing so old handles stay invalid.
+    void Clear()
+    {
+        denseSlots_ = nullptr;
+        slots_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+        freeSlot_ = NO_SLOT;
+        usedSlots_ = 0;
+    }
+    /// Add entity at dense index Size() - 1 and return its handle, or NULL_HANDLE if map is full.
+    EntityHandle Add()
+    {
+        if (size_ >= capacity_)
+        {
+            return NULL_HANDLE;
+        }
+        unsigned slot;
+        if (NO_SLOT != freeSlot_)
+        {
+            slot = freeSlot_;
+            freeSlot_ = slots_[slot].dense_;
+        }
+        else
+        {
+            slot = usedSlots_ ++;
+        }
+        // zero generation is reserved for NULL_HANDLE
+        if (0 == ++ nextGeneration_)
+        {
+            nextGeneration_ = 1;
+        }
+        slots_[slot].dense_ = size_;
+        slots_[slot].generation_ = nextGeneration_;
+        denseSlots_[size_] = slot;
+        size_ ++;
+        EntityHandle handle = { slot, nextGeneration_ };
+        return handle;
+    }
+    /// Remove entity. Owner should move its dense data from index movedFrom to index removed (they are equal when
+    /// the last entity was removed). Return false for stale handle.
+    bool Remove(EntityHandle handle, unsigned& removed, unsigned& movedFrom)
+    {
+        if (false == IsValid(handle))
+        {
+            return false;
+        }
+        removed = slots_[handle.slot_].dense_;
+        movedFrom = size_ - 1;
+        if (removed != movedFrom)
+        {
+            denseSlots_[removed] = denseSlots_[movedFrom];
+            slots_[denseSlots_[removed]].dense_ = removed;
+        }
+        size_ --;
+        slots_[handle.slot_].generation_ = 0;
+        slots_[handle.slot_].dense_ = freeSlot_;
+        freeSlot_ = handle.slot_;
+        return true;
+    }
+    /// Return whether handle refers to a live entity.
+    bool IsValid(EntityHandle handle) const
+    {
+        return handle.slot_ < usedSlots_
+            && 0 != handle.generation_
+            && slots_[handle.slot_].generation_ == handle.generation_;
+    }
+    /// Return dense index of a live entity.
+    unsigned GetIndex(EntityHandle handle) const { return slots_[handle.slot_].dense_; }
+    /// Return slot of a live entity by dense index.
+    unsigned GetSlot(unsigned index) const { return denseSlots_[index]; }
+    /// Return handle of a live entity by dense index.
+    EntityHandle GetHandle(unsigned index) const
+    {
+        unsigned slot = denseSlots_[index];
+        EntityHandle handle = { slot, slots_[slot].generation_ };
+        return handle;
+    }
+    /// Return number of live entities.
+    unsigned Size() const { return size_; }
+    /// Return maximum number of entities.
+    unsigned GetCapacity() const { return capacity_; }
+
+private:
+    static const unsigned NO_SLOT = 0xffffffff;
+
+    struct Slot
+    {
+        /// Index in dense storage, or next free slot while slot is free.
+        unsigned dense_;
+        /// Generation of entity in slot, zero while slot is free.
+        unsigned generation_;
+    };
+
+    HandleMap(const HandleMap&);
+    HandleMap& operator =(const HandleMap&);
+
+    unsigned* denseSlots_;
+    Slot* slots_;
+    unsigned size_;
+    unsigned capacity_;
+    unsigned freeSlot_;
+    unsigned usedSlots_;
+    unsigned nextGeneration_;
+};
+
+/// Generational handle table with dense storage of T, see HandleMap. T should be trivially destructible.
+template <class T> class HandleTable
+{
+public:
+    HandleTable() :
+        dense_(nullptr)
+    {
+    }
+
+    /// Set up storage for up to capacity entities.
+    void Initialize(LevelArena& arena, unsigned capacity)
+    {
+        map_.Initialize(arena, capacity);
+        dense_ = arena.AllocateArray<T>(capacity);
+    }
+    /// Forget all entities, storage is released by the arena.
+    void Clear()
+    {
+        map_.Clear();
+        dense_ = nullptr;
+    }
+    /// Add entity and return its handle, or NULL_HANDLE if table is full.
+    EntityHandle Add(const T& value)
+    {
+        EntityHandle handle = map_.Add();
+        if (NULL_HANDLE != handle)
+        {
+            dense_[map_.Size() - 1] = value;
+        }
+        return handle;
+    }
+    /// Remove entity, last entity takes its place in dense storage. Return false for stale handle.
+    bool Remove(EntityHandle handle)
+    {
+        unsigned removed, movedFrom;
+        if (false == map_.Remove(handle, removed, movedFrom))
+        {
+            return false;
+        }
+        dense_[removed] = dense_[movedFrom];
+        return true;
+    }
+    /// Return whether handle refers to a live entity.
+    bool IsValid(EntityHandle handle) const { return map_.IsValid(handle); }
+    /// Return entity by handle or null for stale handle.
+    T* Get(EntityHandle handle) { return map_.IsValid(handle) ? &dense_[map_.GetIndex(handle)] : nullptr; }
+    const T* Get(EntityHandle handle) const { return map_.IsValid(handle) ? &dense_[map_.GetIndex(handle)] : nullptr; }
+    /// Return number of live entities.
+    unsigned Size() const { return map_.Size(); }
+    /// Return live entity by dense index.
+    T& operator [](unsigned index) { return dense_[index]; }
+    const T& operator [](unsigned index) const { return dense_[index]; }
+    /// Return handle of live entity by dense index.
+    EntityHandle GetHandle(unsigned index) const { return map_.GetHandle(index); }
+
+private:
+    HandleTable(const HandleTable&);
+    HandleTable& operator =(const HandleTable&);
+
+    HandleMap map_;
+    T* dense_;
+};
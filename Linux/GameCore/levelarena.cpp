@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <cstdlib>
+
+#include "levelarena.h"
+
+LevelArena::LevelArena(size_t blockSize) :
+    blockSize_(blockSize),
+    capacity_(0),
+    first_(nullptr),
+    current_(nullptr),
+    offset_(0),
+    usedBefore_(0),
+    failed_(false)
+{
+}
+
+LevelArena::~LevelArena()
+{
+    Block* block = first_;
+    while (nullptr != block)
+    {
+        Block* next = block->next_;
+        free(block);
+        block = next;
+    }
+}
+
+void* LevelArena::Allocate(size_t size, size_t alignment)
+{
+    // blocks are max_align_t aligned, so aligning offset is enough
+    while (true)
+    {
+        if (nullptr != current_)
+        {
+            size_t start = (offset_ + alignment - 1) & ~(alignment - 1);
+            if (start + size <= current_->size_)
+            {
+                offset_ = start + size;
+                return getData(current_) + start;
+            }
+            // block is exhausted, try the next one kept from previous levels
+            if (nullptr != current_->next_)
+            {
+                usedBefore_ += offset_;
+                current_ = current_->next_;
+                offset_ = 0;
+                continue;
+            }
+        }
+        // no suitable block, chain a new one (oversized requests get a block of their own size)
+        size_t dataSize = size + alignment > blockSize_ ? size + alignment : blockSize_;
+        Block* block = static_cast<Block*>(malloc(sizeof(Block) + dataSize));
+        if (nullptr == block)
+        {
+            failed_ = true;
+            return nullptr;
+        }
+        block->next_ = nullptr;
+        block->size_ = dataSize;
+        capacity_ += dataSize;
+        if (nullptr == current_)
+        {
+            first_ = block;
+        }
+        else
+        {
+            usedBefore_ += offset_;
+            // keep blocks following current one, they may be still useful
+            block->next_ = current_->next_;
+            current_->next_ = block;
+        }
+        current_ = block;
+        offset_ = 0;
+    }
+}
+
+void LevelArena::Reset()
+{
+    current_ = first_;
+    offset_ = 0;
+    usedBefore_ = 0;
+    failed_ = false;
+}
+
+size_t LevelArena::GetUsed() const
+{
+    return usedBefore_ + offset_;
+}
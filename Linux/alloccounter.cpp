@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "alloccounter.h"
+
+#ifdef ARKANOID_ALLOC_COUNTER
+
+namespace
+{
+    std::atomic<unsigned> allocCounts[ALLOC_SCOPE_COUNT];
+    std::atomic<unsigned long long> allocBytes(0);
+    // every thread starts as worker, main thread is marked by AllocCounter::SetMainThread()
+    thread_local AllocScope currentScope = ALLOC_SCOPE_WORKER;
+
+    inline void* countedAlloc(std::size_t size)
+    {
+        void* ptr = malloc(0 != size ? size : 1);
+        if (nullptr == ptr)
+        {
+            // engine is built without exceptions on some platforms, so std::bad_alloc is not an option
+            abort();
+        }
+        allocCounts[currentScope].fetch_add(1, std::memory_order_relaxed);
+        allocBytes.fetch_add(size, std::memory_order_relaxed);
+        return ptr;
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return countedAlloc(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    free(ptr);
+}
+
+void AllocCounter::SetMainThread()
+{
+    currentScope = ALLOC_SCOPE_ENGINE;
+}
+
+void AllocCounter::BeginFrame()
+{
+    for (unsigned i = 0; i < ALLOC_SCOPE_COUNT; i ++)
+    {
+        allocCounts[i].store(0, std::memory_order_relaxed);
+    }
+    allocBytes.store(0, std::memory_order_relaxed);
+}
+
+void AllocCounter::EndFrame(AllocStats& stats)
+{
+    for (unsigned i = 0; i < ALLOC_SCOPE_COUNT; i ++)
+    {
+        stats.counts_[i] = allocCounts[i].load(std::memory_order_relaxed);
+    }
+    stats.bytes_ = allocBytes.load(std::memory_order_relaxed);
+}
+
+AllocScope AllocCounter::GetScope()
+{
+    return currentScope;
+}
+
+void AllocCounter::SetScope(AllocScope scope)
+{
+    currentScope = scope;
+}
+
+#else
+
+void AllocCounter::SetMainThread()
+{
+}
+
+void AllocCounter::BeginFrame()
+{
+}
+
+void AllocCounter::EndFrame(AllocStats& stats)
+{
+    for (unsigned i = 0; i < ALLOC_SCOPE_COUNT; i ++)
+    {
+        stats.counts_[i] = 0;
+    }
+    stats.bytes_ = 0;
+}
+
+AllocScope AllocCounter::GetScope()
+{
+    return ALLOC_SCOPE_ENGINE;
+}
+
+void AllocCounter::SetScope(AllocScope /*scope*/)
+{
+}
+
+#endif
@@ -20,10 +20,8 @@
 // THE SOFTWARE.
 //
 
-#include <string>
-#include <sstream>
-
 #include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Timer.h>
 #include <Urho3D/Engine/Application.h>
 #include <Urho3D/Engine/Engine.h>
 #include <Urho3D/Engine/EngineDefs.h>
@@ -62,10 +60,38 @@
 
 #include "ball.h"
 #include "brick.h"
+#include "brickfield.h"
 #include "paddle.h"
 #include "bonus.h"
+#include "alloccounter.h"
+#include "autoplay.h"
+#include "frameprofiler.h"
+#include "framescheduler.h"
+#include "framestats.h"
+#include "gamecore.h"
+#include "gamerunner.h"
+#include "gamesimulation.h"
+#include "levelarena.h"
+#include "physicspacer.h"
+#include "qualitygovernor.h"
+#include "workqueuerunner.h"
 
 using namespace Urho3D;
+
+/// Scripted scenarios of frame time benchmark.
+enum BenchmarkScenario
+{
+    /// Rally over full brick field.
+    BENCHMARK_FULL_FIELD,
+    /// Rally with many bonuses falling at once.
+    BENCHMARK_FALLING_BONUSES,
+    /// Level completed and rebuilt again and again.
+    BENCHMARK_LEVEL_TRANSITION,
+    /// Game paused and resumed again and again.
+    BENCHMARK_PAUSE_RESUME,
+    BENCHMARK_COUNT
+};
+
 /**
 * Using the convenient Application API we don't have
 * to worry about initializing the engine or writing a main.
@@ -79,20 +105,83 @@ protected:
     float time_;
     SharedPtr<PhysicsWorld> physicsWorld_;
     SharedPtr<Scene> scene_;
-    SharedPtr<Node> skyNode_, fieldNode_, fieldBordersNode_, ballNode_, paddleNode_;
+    SharedPtr<Node> skyNode_, lightNode_, fieldNode_, fieldBordersNode_, ballNode_, paddleNode_;
     SharedPtr<Node> cameraNode_;
+    /// Parents of brick and bonus nodes of current level.
+    SharedPtr<Node> bricksNode_, bonusesNode_;
     SharedPtr<Button> pauseButton_;
     SharedPtr<Window> scoresPanel_;
     SharedPtr<Text> scoresText_;
     SharedPtr<SoundSource> musicSource_;
-    Vector<SharedPtr<Node> > bricks_;
-    Vector<SharedPtr<Node> > bonuses_;
+    /// Game rules, scene mirrors its state.
+    GameCore core_;
+    /// Runs entity updates of large levels of game core in parallel.
+    WorkQueueJobRunner jobRunner_;
+    // per-level node tables live in level arena and are released at once in clearLevel()
+    LevelArena levelArena_;
+    /// Collision shapes of intact bricks of current level, as one static body.
+    SharedPtr<BrickField> brickField_;
+    /// Brick and bonus nodes indexed by slot of their handles, nodes are owned by scene.
+    Node** brickNodes_;
+    Node** bonusNodes_;
+    unsigned nodeCapacity_;
 
-    Vector3 ballOffsetOriginal_;
+    /// Ball position relative to paddle while ball rests on it.
     Vector3 ballOffset_;
     float velocity_;
     bool paused_;
-    unsigned scores_;
+    /// Scene has nodes of current level, game doesn't run before they are created after the first frame.
+    bool levelReady_;
+    /// Game core completed level during physics step, scene is rebuilt for the next one in the following update.
+    bool levelChangePending_;
+    unsigned shownScores_;
+    String scoresString_;
+    /// Paddle is driven by AutoPlayer, see -autoplay command line option.
+    bool autoplay_;
+    // headless games, see -simulate and -runner command line options
+    bool headless_;
+    bool simulate_;
+    bool simulationDone_;
+    unsigned seed_;
+    unsigned maxLevels_;
+    float maxTime_;
+    unsigned lostBalls_;
+    String resultPath_;
+    PODVector<float> frameTimes_;
+    HiresTimer frameTimer_;
+    SharedPtr<GameRunner> runner_;
+    // game core stepped on its own thread, see -simthread command line option
+    bool simThread_;
+    UniquePtr<GameSimulation> simulation_;
+    unsigned shownLevel_;
+    /// Lowers frame rate of interactive game while it is idle.
+    SharedPtr<FrameScheduler> frameScheduler_;
+    /// Steps rendering quality and frame rate of interactive game to keep frame time in budget.
+    SharedPtr<QualityGovernor> qualityGovernor_;
+    /// Caps physics substeps per frame and slows game time while physics is overloaded.
+    SharedPtr<PhysicsPacer> physicsPacer_;
+    // frame time benchmark, see -benchmark command line option
+    bool benchmark_;
+    unsigned benchmarkScenario_;
+    unsigned scenarioFrame_;
+    unsigned scenarioFrames_;
+    String benchmarkPath_;
+    SharedPtr<FrameProfiler> profiler_;
+    JSONValue benchmarkResults_;
+    /// Time from application construction until the end of first frame in milliseconds.
+    HiresTimer startupTimer_;
+    float startupTime_;
+    /// Durations of level construction in prepareLevel() and of level teardown in clearLevel() during benchmark in
+    /// milliseconds.
+    PODVector<float> levelBuildTimes_;
+    PODVector<float> levelTeardownTimes_;
+#ifdef ARKANOID_ALLOC_COUNTER
+    // allocation counter statistics, see ARKANOID_ALLOC_COUNTER build option
+    unsigned rallyFrames_;
+    unsigned allocatingFrames_;
+    bool allocCheck_;
+    unsigned long long scenarioAllocs_;
+#endif
 public:
     Arkanoid(Context * context);
     virtual void Setup();
@@ -100,13 +189,40 @@ public:
     virtual void Stop();
 protected:
     void setupPhysicalProperties(RigidBody* rigidBody);
-    Node* setupNode(const String& model, const String& material, const String& nodeName = String::EMPTY, bool setupShape = true);
+    Node* setupNode(const String& model, const String& material, const String& nodeName = String::EMPTY, bool setupShape = true,
+                    bool setupBody = true, Node* parent = nullptr);
+    void parseOptions();
+    void startRunner();
+    void createUi();
+    void configureOctree(float brickWidth);
+    void configureCore();
     void clearLevel();
-    void clearActiveBonuses();
-    void clearBonuses();
     void prepareLevel();
+    void launchBall();
+    void resetBall();
+    void handleCoreEvents();
+    void finishStartup();
     void startMusic();
+    void updateUiLayout();
+    void updateScoresText(unsigned scores);
+    void togglePause();
     void handlePause(StringHash eventType, VariantMap& eventData);
+    float getFieldX(const IntVector2& position);
     void handleKeyDown(StringHash eventType,VariantMap& eventData);
     void handleUpdate(StringHash eventType,VariantMap& eventData);
+    void handleScreenMode(StringHash eventType, VariantMap& eventData);
+    void handlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    void handlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+    void handleBeginFrame(StringHash eventType, VariantMap& eventData);
+    void handleEndFrame(StringHash eventType, VariantMap& eventData);
+    void startSimulationThread();
+    void updateFromSimulation(unsigned touches, float timeStep);
+    void updateSimulation();
+    void finishSimulation();
+    void startScenario(unsigned scenario);
+    void updateBenchmark();
+    void finishScenario();
+#ifdef ARKANOID_ALLOC_COUNTER
+    void checkFrameAllocations();
+#endif
 };
@@ -29,6 +29,7 @@
 #include <Urho3D/Scene/Scene.h>
 #include <Urho3D/Scene/SceneEvents.h>
 
+#include "alloccounter.h"
 #include "ball.h"
 
 Ball::Ball(Context* context) :
@@ -52,6 +53,16 @@ void Ball::Start()
     // get sounds
     ResourceCache* cache = GetSubsystem<ResourceCache>();
     hitSound_ = cache->GetResource<Sound>("Sounds/PlayerFistHit.wav");
+    // Create SoundSource components for playing hit sounds once, so hits don't create and remove components.
+    // The SoundSource component plays non-positional audio, so its 3D position in the scene does not matter.
+    // For positional sounds the SoundSource3D component would be used instead
+    for (unsigned i = 0; i < HIT_SOUND_SOURCES; i ++)
+    {
+        SoundSource* soundSource = node_->GetScene()->CreateComponent<SoundSource>();
+        // In case we also play music, set the sound volume below maximum so that we don't clip the output
+        soundSource->SetGain(0.75f);
+        soundSources_.Push(SharedPtr<SoundSource>(soundSource));
+    }
     // Component has been inserted into its scene node. Subscribe to events now
     SubscribeToEvent(GetNode(), E_NODECOLLISION, URHO3D_HANDLER(Ball, handleNodeCollision));
 }
@@ -67,27 +78,33 @@ void Ball::FixedUpdate(float /*timeStep*/)
 
 void Ball::playSound(Sound* sound)
 {
-    if (nullptr != sound)
+    ALLOC_SCOPE(ALLOC_SCOPE_AUDIO);
+    if (nullptr != sound
+        && false == soundSources_.Empty())
     {
-        // Create a SoundSource component for playing the sound. The SoundSource component plays
-        // non-positional audio, so its 3D position in the scene does not matter. For positional sounds the
-        // SoundSource3D component would be used instead
-        SoundSource* soundSource = node_->GetScene()->CreateComponent<SoundSource>();
-        // Component will automatically remove itself when the sound finished playing
-        soundSource->SetAutoRemoveMode(REMOVE_COMPONENT);
+        // take first idle sound source, if all of them are busy restart the first one
+        SoundSource* soundSource = soundSources_[0];
+        for (unsigned i = 0; i < soundSources_.Size(); i ++)
+        {
+            if (false == soundSources_[i]->IsPlaying())
+            {
+                soundSource = soundSources_[i];
+                break;
+            }
+        }
         soundSource->Play(sound);
-        // In case we also play music, set the sound volume below maximum so that we don't clip the output
-        soundSource->SetGain(0.75f);
     }
 }
 
 void Ball::handleNodeCollision(StringHash /*eventType*/, VariantMap& eventData)
 {
     using namespace NodeCollision;
-    
+    ALLOC_SCOPE(ALLOC_SCOPE_GAME);
+
+    // compare with plain strings, temporary String objects would allocate on every contact
     Node* otherNode = reinterpret_cast<Node*>(eventData[P_OTHERNODE].GetVoidPtr());
-    if (String("Brick") == otherNode->GetName()
-        || String("Paddle") == otherNode->GetName())
+    if (otherNode->GetName() == "BrickField"
+        || otherNode->GetName() == "Paddle")
     {
         playSound(hitSound_);
     }
@@ -25,16 +25,12 @@
 #include <Urho3D/Input/Controls.h>
 #include <Urho3D/Scene/LogicComponent.h>
 
-using namespace Urho3D;
-
-enum { BONUS_NONE, BONUS_SHRINKPADDLE, BONUS_EXTENDPADDLE,
-        BONUS_100, BONUS_200, BONUS_500,
-        BONUS_1000, BONUS_2000, BONUS_5000, BONUS_10000, BONUS_COUNT };
+#include "gamecore.h"
 
-const float BONUS_SPEED = 0.2f;
-const float FIELD_WIDTH = 2;
-const float FIELD_HEIGHT = 2;
+using namespace Urho3D;
 
+/// Scene side of a bonus, gameplay state lives in GameCore. Bonus has no physics body: game core moves it and tests
+/// its overlaps with paddle and other bonuses, node only follows.
 class Bonus : public LogicComponent
 {
     URHO3D_OBJECT(Bonus, LogicComponent);
@@ -42,16 +38,13 @@ public:
     Bonus(Context* context);
     /// Register object factory and attributes.
     static void RegisterObject(Context* context);
-    /// Handle startup. Called by LogicComponent base class.
-    virtual void Start();
-    /// Handle physics world update. Called by LogicComponent base class.
-    virtual void FixedUpdate(float timeStep);
-    virtual void SetBonusType(unsigned bonusType) { bonusType_ = bonusType; }
-    virtual unsigned GetBonusType() { return bonusType_; }
+    /// Handle scene update. Called by LogicComponent base class.
+    virtual void Update(float timeStep);
+    /// Attach to bonus state in game core.
+    void SetState(GameCore* core, EntityHandle handle);
+    EntityHandle GetHandle() const { return handle_; }
+    virtual unsigned GetBonusType();
 private:
-    /// Handle physics collision event.
-    void handleNodeCollision(StringHash eventType, VariantMap& eventData);
-
-    unsigned bonusType_;
-    float bonusSpeed_;
+    GameCore* core_;
+    EntityHandle handle_;
 };
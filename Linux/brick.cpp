@@ -21,26 +21,16 @@
 //
 
 #include <Urho3D/Core/Context.h>
-#include <Urho3D/Graphics/AnimationController.h>
-#include <Urho3D/IO/MemoryBuffer.h>
-#include <Urho3D/Physics/PhysicsEvents.h>
-#include <Urho3D/Physics/PhysicsWorld.h>
-#include <Urho3D/Physics/RigidBody.h>
-#include <Urho3D/Scene/Scene.h>
-#include <Urho3D/Scene/SceneEvents.h>
 
 #include "brick.h"
 
 Brick::Brick(Context* context) :
-    LogicComponent(context)
+    LogicComponent(context),
+    core_(nullptr),
+    handle_(NULL_HANDLE)
 {
-    scores_ = BRICK_SCORES;
-    isCollapsing_ = false;
-    isCollapsed_ = false;
-//     bonusType_ = BONUS_NONE;
-    shrinkTime_ = 0;
-    // Only the physics update event is needed: unsubscribe from the rest for optimization
-    SetUpdateEventMask(USE_UPDATE);
+    // state is updated by GameCore, collisions are handled by BrickField
+    SetUpdateEventMask(0);
 }
 
 void Brick::RegisterObject(Context* context)
@@ -48,64 +38,13 @@ void Brick::RegisterObject(Context* context)
     context->RegisterFactory<Brick>();
 }
 
-void Brick::Start()
+void Brick::SetState(GameCore* core, EntityHandle handle)
 {
-    // Component has been inserted into its scene node. Subscribe to events now
-    SubscribeToEvent(GetNode(), E_NODECOLLISION, URHO3D_HANDLER(Brick, handleNodeCollision));
+    core_ = core;
+    handle_ = handle;
 }
 
-void Brick::Update(float timeStep)
+bool Brick::IsCollapsed()
 {
-    if (false == isCollapsed_
-        && 0 < shrinkTime_)
-    {
-        shrinkTime_ -= Min(timeStep, shrinkTime_);
-        node_->SetScale(shrinkTime_ / SHRINK_TIME);
-        isCollapsed_ = (Abs(shrinkTime_) < 1e-6f);
-    }
-}
-
-int Brick::GetScores()
-{
-    if (false != isCollapsed_
-        || 0 != shrinkTime_)
-    {
-        float retVal = scores_;
-        scores_ = 0;
-        return retVal;
-    }
-    return 0;
-}
-
-bool Brick::IsCollapsing()
-{
-    bool result = isCollapsing_;
-    isCollapsing_ = false;
-    return result;
-}
-
-void Brick::handleNodeCollision(StringHash eventType, VariantMap& eventData)
-{
-    using namespace NodeCollision;
-
-    Node* otherNode = reinterpret_cast<Node*>(eventData[P_OTHERNODE].GetVoidPtr());;
-    if (String("Ball") == otherNode->GetName())
-    {
-        if (0 == shrinkTime_)
-        {
-            isCollapsing_ = true;
-            shrinkTime_ = SHRINK_TIME;
-        }
-    }
-
-    MemoryBuffer contacts(eventData[P_CONTACTS].GetBuffer());
-
-    while (!contacts.IsEof())
-    {
-        /*Vector3 contactPosition = */contacts.ReadVector3();
-        /*Vector3 contactNormal = */contacts.ReadVector3();
-        /*float contactDistance = */contacts.ReadFloat();
-        /*float contactImpulse = */contacts.ReadFloat();
-
-    }
+    return nullptr != core_ && core_->GetBricks().IsCollapsed(handle_);
 }
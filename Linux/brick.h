@@ -25,13 +25,11 @@
 #include <Urho3D/Input/Controls.h>
 #include <Urho3D/Scene/LogicComponent.h>
 
-#include "bonus.h"
-
-const int BRICK_SCORES = 10;
-const float SHRINK_TIME = 0.5f;
+#include "gamecore.h"
 
 using namespace Urho3D;
 
+/// Scene side of a brick, gameplay state lives in GameCore and collision shape in BrickField.
 class Brick : public LogicComponent
 {
     URHO3D_OBJECT(Brick, LogicComponent);
@@ -39,19 +37,12 @@ public:
     Brick(Context* context);
     /// Register object factory and attributes.
     static void RegisterObject(Context* context);
-    /// Handle startup. Called by LogicComponent base class.
-    virtual void Start();
-    /// Handle physics world update. Called by LogicComponent base class.
-    virtual void Update(float timeStep);
-    virtual bool IsCollapsed() { return isCollapsed_; }
-    virtual bool IsCollapsing();
-    virtual int GetScores();
+    /// Attach to brick state in game core.
+    void SetState(GameCore* core, EntityHandle handle);
+    EntityHandle GetHandle() const { return handle_; }
+    virtual bool IsCollapsed();
 
 private:
-    /// Handle physics collision event.
-    void handleNodeCollision(StringHash eventType, VariantMap& eventData);
-    
-    int scores_;
-    bool isCollapsing_, isCollapsed_;
-    float shrinkTime_;
+    GameCore* core_;
+    EntityHandle handle_;
 };
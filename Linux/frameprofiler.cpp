@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Graphics/GraphicsEvents.h>
+#include <Urho3D/Physics/PhysicsEvents.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "frameprofiler.h"
+
+FrameProfiler::FrameProfiler(Context* context) :
+    Object(context),
+    updateEnd_(0),
+    uiUpdateEnd_(0),
+    viewEnd_(0),
+    renderEnd_(0),
+    physicsBegin_(0),
+    physics_(0)
+{
+}
+
+void FrameProfiler::Start(Scene* scene)
+{
+    // subscribed last, so these run after game logic and scene update of E_UPDATE and after ui update of E_POSTUPDATE
+    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(FrameProfiler, handleUpdate));
+    SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(FrameProfiler, handlePostUpdate));
+    SubscribeToEvent(E_ENDVIEWRENDER, URHO3D_HANDLER(FrameProfiler, handleEndViewRender));
+    SubscribeToEvent(E_ENDRENDERING, URHO3D_HANDLER(FrameProfiler, handleEndRendering));
+    PhysicsWorld* physicsWorld = scene->GetComponent<PhysicsWorld>();
+    if (nullptr != physicsWorld)
+    {
+        SubscribeToEvent(physicsWorld, E_PHYSICSPRESTEP, URHO3D_HANDLER(FrameProfiler, handlePhysicsPreStep));
+        SubscribeToEvent(physicsWorld, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(FrameProfiler, handlePhysicsPostStep));
+    }
+}
+
+void FrameProfiler::BeginFrame()
+{
+    timer_.Reset();
+    updateEnd_ = uiUpdateEnd_ = viewEnd_ = renderEnd_ = -1;
+    physics_ = 0;
+}
+
+void FrameProfiler::EndFrame()
+{
+    long long frameEnd = now();
+    // missing boundaries (headless, minimized window) collapse their phases
+    long long updateEnd = updateEnd_ >= 0 ? updateEnd_ : frameEnd;
+    long long uiUpdateEnd = uiUpdateEnd_ >= 0 ? uiUpdateEnd_ : updateEnd;
+    long long viewEnd = viewEnd_ >= 0 ? viewEnd_ : uiUpdateEnd;
+    long long renderEnd = renderEnd_ >= 0 ? renderEnd_ : viewEnd;
+    samples_[FRAME_PHASE_FRAME].Push(frameEnd * 0.001f);
+    samples_[FRAME_PHASE_UPDATE].Push((updateEnd - physics_) * 0.001f);
+    samples_[FRAME_PHASE_PHYSICS].Push(physics_ * 0.001f);
+    samples_[FRAME_PHASE_RENDER].Push((viewEnd - uiUpdateEnd) * 0.001f);
+    samples_[FRAME_PHASE_UI].Push(((uiUpdateEnd - updateEnd) + (renderEnd - viewEnd)) * 0.001f);
+}
+
+void FrameProfiler::Clear()
+{
+    for (unsigned i = 0; i < FRAME_PHASE_COUNT; i ++)
+    {
+        samples_[i].Clear();
+    }
+}
+
+void FrameProfiler::Compute(FrameStats stats[FRAME_PHASE_COUNT])
+{
+    for (unsigned i = 0; i < FRAME_PHASE_COUNT; i ++)
+    {
+        stats[i].Compute(samples_[i]);
+    }
+}
+
+const char* FrameProfiler::GetPhaseName(unsigned phase)
+{
+    static const char* names[] = { "frame", "update", "physics", "render", "ui" };
+    return phase < FRAME_PHASE_COUNT ? names[phase] : "";
+}
+
+void FrameProfiler::handleUpdate(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    updateEnd_ = now();
+}
+
+void FrameProfiler::handlePostUpdate(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    uiUpdateEnd_ = now();
+}
+
+void FrameProfiler::handleEndViewRender(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    // last view of the frame ends scene rendering
+    viewEnd_ = now();
+}
+
+void FrameProfiler::handleEndRendering(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    renderEnd_ = now();
+}
+
+void FrameProfiler::handlePhysicsPreStep(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    physicsBegin_ = now();
+}
+
+void FrameProfiler::handlePhysicsPostStep(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    physics_ += now() - physicsBegin_;
+}
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Graphics/GraphicsEvents.h>
+#include <Urho3D/Input/InputEvents.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/UI/UIEvents.h>
+
+#include "framescheduler.h"
+
+namespace
+{
+// time without input before frame rate is lowered, milliseconds
+const unsigned IDLE_DELAY = 2000;
+const unsigned MINUTE = 60000;
+}
+
+FrameScheduler::FrameScheduler(Context* context) :
+    Object(context),
+    activeFps_(0),
+    idleFps_(0),
+    idle_(false),
+    renderedFrames_(0),
+    idleFrames_(0),
+    framesPerMinute_(0)
+{
+}
+
+void FrameScheduler::Start(int activeFps, int idleFps)
+{
+    activeFps_ = activeFps;
+    idleFps_ = idleFps;
+    GetSubsystem<Engine>()->SetMaxFps(activeFps_);
+    // any input or window change can change what is on screen
+    SubscribeToEvent(E_KEYDOWN, URHO3D_HANDLER(FrameScheduler, handleInput));
+    SubscribeToEvent(E_MOUSEBUTTONDOWN, URHO3D_HANDLER(FrameScheduler, handleInput));
+    SubscribeToEvent(E_MOUSEMOVE, URHO3D_HANDLER(FrameScheduler, handleInput));
+    SubscribeToEvent(E_MOUSEWHEEL, URHO3D_HANDLER(FrameScheduler, handleInput));
+    SubscribeToEvent(E_TOUCHBEGIN, URHO3D_HANDLER(FrameScheduler, handleInput));
+    SubscribeToEvent(E_TOUCHMOVE, URHO3D_HANDLER(FrameScheduler, handleInput));
+    SubscribeToEvent(E_HOVERBEGIN, URHO3D_HANDLER(FrameScheduler, handleInput));
+    SubscribeToEvent(E_SCREENMODE, URHO3D_HANDLER(FrameScheduler, handleInput));
+    SubscribeToEvent(E_ENDRENDERING, URHO3D_HANDLER(FrameScheduler, handleEndRendering));
+    inputTimer_.Reset();
+    minuteTimer_.Reset();
+}
+
+void FrameScheduler::SetIdleAllowed(bool allowed)
+{
+    if (false == allowed)
+    {
+        inputTimer_.Reset();
+        wake();
+    }
+    else if (false == idle_
+             && inputTimer_.GetMSec(false) >= IDLE_DELAY)
+    {
+        idle_ = true;
+        GetSubsystem<Engine>()->SetMaxFps(idleFps_);
+    }
+}
+
+void FrameScheduler::SetActiveFps(int fps)
+{
+    activeFps_ = fps;
+    if (false == idle_)
+    {
+        GetSubsystem<Engine>()->SetMaxFps(activeFps_);
+    }
+}
+
+void FrameScheduler::wake()
+{
+    if (false != idle_)
+    {
+        idle_ = false;
+        GetSubsystem<Engine>()->SetMaxFps(activeFps_);
+    }
+}
+
+void FrameScheduler::handleInput(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    inputTimer_.Reset();
+    // the rest of this frame and the next one run at full rate
+    wake();
+}
+
+void FrameScheduler::handleEndRendering(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    renderedFrames_ ++;
+    if (false != idle_)
+    {
+        idleFrames_ ++;
+    }
+    if (minuteTimer_.GetMSec(false) >= MINUTE)
+    {
+        framesPerMinute_ = renderedFrames_;
+        URHO3D_LOGINFOF("Frames rendered in the last minute: %u, %u of them at idle rate", renderedFrames_, idleFrames_);
+        renderedFrames_ = 0;
+        idleFrames_ = 0;
+        minuteTimer_.Reset();
+    }
+}
@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Core/Timer.h>
+
+using namespace Urho3D;
+
+/// Lowers engine frame rate while nothing on screen depends on player, e.g. game is paused or ball waits on paddle,
+/// and restores full frame rate as soon as input arrives. Sky keeps rotating at the idle rate. Logs frames rendered
+/// per minute.
+class FrameScheduler : public Object
+{
+    URHO3D_OBJECT(FrameScheduler, Object);
+public:
+    FrameScheduler(Context* context);
+    /// Start scheduling, engine runs at activeFps until idle is allowed and there is no input for a while.
+    void Start(int activeFps, int idleFps);
+    /// Allow or forbid idle frame rate, call every frame.
+    void SetIdleAllowed(bool allowed);
+    /// Change full frame rate.
+    void SetActiveFps(int fps);
+    /// Return full frame rate.
+    int GetActiveFps() const { return activeFps_; }
+    /// Return whether frame rate is lowered.
+    bool IsIdle() const { return idle_; }
+    /// Return frames rendered during the last full minute.
+    unsigned GetFramesPerMinute() const { return framesPerMinute_; }
+
+private:
+    /// Go back to full frame rate.
+    void wake();
+    void handleInput(StringHash eventType, VariantMap& eventData);
+    void handleEndRendering(StringHash eventType, VariantMap& eventData);
+
+    int activeFps_;
+    int idleFps_;
+    bool idle_;
+    Timer inputTimer_;
+    Timer minuteTimer_;
+    unsigned renderedFrames_;
+    unsigned idleFrames_;
+    unsigned framesPerMinute_;
+};
@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Container/Sort.h>
+
+#include "framestats.h"
+
+namespace
+{
+// nearest rank percentile of sorted samples
+float percentile(const PODVector<float>& sorted, float share)
+{
+    unsigned rank = unsigned(share * (sorted.Size() - 1) + 0.5f);
+    return sorted[rank];
+}
+}
+
+FrameStats::FrameStats() :
+    count_(0),
+    mean_(0),
+    p50_(0),
+    p95_(0),
+    p99_(0),
+    max_(0)
+{
+}
+
+void FrameStats::Compute(PODVector<float>& samples)
+{
+    count_ = samples.Size();
+    if (0 == count_)
+    {
+        mean_ = p50_ = p95_ = p99_ = max_ = 0;
+        return;
+    }
+    Sort(samples.Begin(), samples.End());
+    double sum = 0;
+    for (unsigned i = 0; i < count_; i ++)
+    {
+        sum += samples[i];
+    }
+    mean_ = float(sum / count_);
+    p50_ = percentile(samples, 0.5f);
+    p95_ = percentile(samples, 0.95f);
+    p99_ = percentile(samples, 0.99f);
+    max_ = samples.Back();
+}
+
+void FrameStats::Save(JSONValue& value) const
+{
+    value.Set("frames", count_);
+    value.Set("meanMs", mean_);
+    value.Set("p50Ms", p50_);
+    value.Set("p95Ms", p95_);
+    value.Set("p99Ms", p99_);
+    value.Set("maxMs", max_);
+}
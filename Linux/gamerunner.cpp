@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/IOEvents.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/JSONFile.h>
+
+#include "gamerunner.h"
+
+GameRunner::GameRunner(Context* context) :
+    Object(context),
+    games_(0),
+    jobs_(1),
+    firstSeed_(0),
+    nextGame_(0),
+    runningJobs_(0),
+    failedGames_(0)
+{
+}
+
+void GameRunner::Start(unsigned games, unsigned jobs, unsigned firstSeed, const String& outputPath, const Vector<String>& extraArguments)
+{
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+#ifdef _WIN32
+    program_ = fileSystem->GetProgramDir() + "Arkanoid.exe";
+#else
+    program_ = fileSystem->GetProgramDir() + "Arkanoid";
+#endif
+    outputPath_ = outputPath;
+    extraArguments_ = extraArguments;
+    games_ = games;
+    jobs_ = Max(jobs, 1U);
+    firstSeed_ = firstSeed;
+    nextGame_ = 0;
+    runningJobs_ = 0;
+    failedGames_ = 0;
+    results_.Clear();
+    results_.Resize(games_);
+    timer_.Reset();
+    URHO3D_LOGINFOF("Running %u games, %u at once", games_, jobs_);
+    SubscribeToEvent(E_ASYNCEXECFINISHED, URHO3D_HANDLER(GameRunner, handleAsyncExecFinished));
+    launchGames();
+    // nothing to wait for when there are no games or none of them could be started
+    if (0 == runningJobs_
+        && nextGame_ >= games_)
+    {
+        writeSummary();
+    }
+}
+
+void GameRunner::launchGames()
+{
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+    while (runningJobs_ < jobs_
+        && nextGame_ < games_)
+    {
+        unsigned seed = firstSeed_ + nextGame_;
+        Vector<String> arguments;
+        arguments.Push("-simulate");
+        arguments.Push("-seed");
+        arguments.Push(String(seed));
+        arguments.Push("-result");
+        arguments.Push(getResultPath(seed));
+        arguments.Push(extraArguments_);
+        unsigned request = fileSystem->SystemRunAsync(program_, arguments);
+        if (M_MAX_UNSIGNED == request)
+        {
+            URHO3D_LOGERRORF("Failed to start game with seed %u", seed);
+            failedGames_ ++;
+        }
+        else
+        {
+            requests_[request] = nextGame_;
+            runningJobs_ ++;
+        }
+        nextGame_ ++;
+    }
+}
+
+String GameRunner::getResultPath(unsigned seed) const
+{
+    return GetPath(outputPath_) + "game_" + String(seed) + ".json";
+}
+
+void GameRunner::handleAsyncExecFinished(StringHash /*eventType*/, VariantMap& eventData)
+{
+    using namespace AsyncExecFinished;
+    HashMap<unsigned, unsigned>::Iterator request = requests_.Find(eventData[P_REQUESTID].GetUInt());
+    if (request == requests_.End())
+    {
+        return;
+    }
+    unsigned game = request->second_;
+    requests_.Erase(request);
+    runningJobs_ --;
+
+    unsigned seed = firstSeed_ + game;
+    String resultPath = getResultPath(seed);
+    SharedPtr<JSONFile> result(new JSONFile(context_));
+    if (0 == eventData[P_EXITCODE].GetInt()
+        && false != result->LoadFile(resultPath))
+    {
+        results_[game] = result->GetRoot();
+    }
+    else
+    {
+        URHO3D_LOGERRORF("Game with seed %u failed with exit code %d", seed, eventData[P_EXITCODE].GetInt());
+        failedGames_ ++;
+    }
+    GetSubsystem<FileSystem>()->Delete(resultPath);
+
+    launchGames();
+    if (0 == runningJobs_
+        && nextGame_ >= games_)
+    {
+        writeSummary();
+    }
+}
+
+void GameRunner::writeSummary()
+{
+    SharedPtr<JSONFile> summary(new JSONFile(context_));
+    JSONValue& root = summary->GetRoot();
+    JSONValue games;
+    double totalScores = 0;
+    double totalTime = 0;
+    unsigned finishedGames = 0;
+    for (unsigned i = 0; i < results_.Size(); i ++)
+    {
+        if (false == results_[i].IsNull())
+        {
+            totalScores += results_[i].Get("scores").GetUInt();
+            totalTime += results_[i].Get("gameTime").GetFloat();
+            finishedGames ++;
+            games.Push(results_[i]);
+        }
+    }
+    root.Set("games", games);
+    root.Set("finished", finishedGames);
+    root.Set("failed", failedGames_);
+    root.Set("meanScores", finishedGames > 0 ? float(totalScores / finishedGames) : 0.0f);
+    root.Set("meanGameTime", finishedGames > 0 ? float(totalTime / finishedGames) : 0.0f);
+    root.Set("wallTime", timer_.GetMSec(false) * 0.001f);
+    if (false == summary->SaveFile(outputPath_))
+    {
+        URHO3D_LOGERRORF("Failed to write %s", outputPath_.CString());
+    }
+    URHO3D_LOGINFOF("%u games finished, %u failed, results in %s", finishedGames, failedGames_, outputPath_.CString());
+    GetSubsystem<Engine>()->Exit();
+}
@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Resource/JSONValue.h>
+
+using namespace Urho3D;
+
+/// Plays many headless games in child processes of the game executable, at most jobs at a time, and writes their
+/// results in seed order. Every game runs with fixed time step in its own process, so its result depends on its seed
+/// only, no matter how many games run at once.
+class GameRunner : public Object
+{
+    URHO3D_OBJECT(GameRunner, Object);
+public:
+    GameRunner(Context* context);
+    /// Start games with seeds firstSeed .. firstSeed + games - 1. Extra arguments are passed to every game.
+    /// Engine exits after summary is written to outputPath.
+    void Start(unsigned games, unsigned jobs, unsigned firstSeed, const String& outputPath, const Vector<String>& extraArguments);
+
+private:
+    /// Start games until jobs limit is reached.
+    void launchGames();
+    String getResultPath(unsigned seed) const;
+    void writeSummary();
+    void handleAsyncExecFinished(StringHash eventType, VariantMap& eventData);
+
+    String program_;
+    String outputPath_;
+    Vector<String> extraArguments_;
+    unsigned games_;
+    unsigned jobs_;
+    unsigned firstSeed_;
+    unsigned nextGame_;
+    unsigned runningJobs_;
+    unsigned failedGames_;
+    /// Game index by async execution request id.
+    HashMap<unsigned, unsigned> requests_;
+    /// Results by game index, null for failed games.
+    Vector<JSONValue> results_;
+    Timer timer_;
+};
@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+
+using namespace Urho3D;
+
+class PhysicsWorld;
+class Scene;
+
+/// Physics stepping counters since the last reset.
+struct PhysicsPacerStats
+{
+    /// Frames with physics update enabled.
+    unsigned frames_;
+    unsigned subSteps_;
+    unsigned maxSubSteps_;
+    /// Frames stepped while overloaded.
+    unsigned overloadedFrames_;
+    /// Game time not simulated because substeps were capped, seconds.
+    float timeDropped_;
+    /// Real time game fell behind because time was slowed, seconds.
+    float timeSlowed_;
+};
+
+/// Runs physics world at fixed rate with capped number of substeps per frame, so a slow frame doesn't make the next
+/// frame slower with catch-up substeps. Cap covers substeps a frame at current target frame rate needs, so idle frame
+/// rate doesn't count as overload. When frames hit the cap several times in a row, physics is overloaded: game time
+/// is slowed in steps down to half speed, so the game runs in slow motion instead of jumping, and is sped up again
+/// after a while without hitting the cap. Every change is logged.
+class PhysicsPacer : public Object
+{
+    URHO3D_OBJECT(PhysicsPacer, Object);
+public:
+    PhysicsPacer(Context* context);
+    /// Set physics rate and substep cap of scene's physics world and start watching its frames.
+    void Start(Scene* scene, int fps, int maxSubSteps);
+    /// Return whether game time is slowed because of overload.
+    bool IsOverloaded() const { return overloaded_; }
+    /// Return current scene time scale.
+    float GetTimeScale() const { return timeScale_; }
+    /// Return substeps of the last frame.
+    unsigned GetFrameSubSteps() const { return frameSubSteps_; }
+    /// Return counters since the last reset.
+    const PhysicsPacerStats& GetStats() const { return stats_; }
+    /// Reset counters.
+    void ResetStats();
+
+private:
+    void setTimeScale(float timeScale);
+    void handleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    void handlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    void handleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+
+    WeakPtr<Scene> scene_;
+    WeakPtr<PhysicsWorld> physicsWorld_;
+    float fixedStep_;
+    int maxSubSteps_;
+    /// Substep cap of current frame.
+    int frameCap_;
+    unsigned frameSubSteps_;
+    /// Scaled game time not simulated yet, mirrors time accumulator of physics world.
+    float timeAccumulator_;
+    float timeScale_;
+    bool overloaded_;
+    /// Consecutive frames that hit the cap and that stayed under it.
+    unsigned cappedFrames_;
+    unsigned calmFrames_;
+    PhysicsPacerStats stats_;
+};
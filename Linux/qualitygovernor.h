@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Core/Timer.h>
+
+using namespace Urho3D;
+
+class FrameScheduler;
+
+/// Rendering settings of quality tier.
+struct QualityTier
+{
+    /// Tier name in log.
+    const char* name_;
+    bool shadows_;
+    int shadowMapSize_;
+    int materialQuality_;
+    int maxFps_;
+};
+
+/// Keeps frame time within budget of current tier by stepping quality tiers down and up. Frame time is CPU time from
+/// begin of frame to end of rendering, so frame limiter sleep and present don't count, summarized as 95th percentile
+/// over a window of frames. Tier goes down after two windows over budget and up after several windows well under budget
+/// of better tier, and doesn't change again for a while after every change, so it settles instead of oscillating. Every
+/// decision is logged.
+class QualityGovernor : public Object
+{
+    URHO3D_OBJECT(QualityGovernor, Object);
+public:
+    QualityGovernor(Context* context);
+    /// Apply initial tier and start watching frames, frame rate of tiers is set through scheduler.
+    void Start(unsigned tier, FrameScheduler* scheduler);
+    /// Return current tier.
+    unsigned GetTier() const { return tier_; }
+    /// Return number of tiers, tier 0 is the best one.
+    static unsigned GetNumTiers();
+
+private:
+    void applyTier(unsigned tier);
+    /// Decide on tier change after window of frames is complete.
+    void evaluate();
+    void handleBeginFrame(StringHash eventType, VariantMap& eventData);
+    void handleEndRendering(StringHash eventType, VariantMap& eventData);
+
+    WeakPtr<FrameScheduler> scheduler_;
+    unsigned tier_;
+    HiresTimer frameTimer_;
+    PODVector<float> samples_;
+    /// Consecutive windows over budget and well under budget of better tier.
+    unsigned slowWindows_;
+    unsigned fastWindows_;
+    /// Windows to skip after tier change.
+    unsigned cooldown_;
+};
@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+#include "workqueuerunner.h"
+
+WorkQueueJobRunner::WorkQueueJobRunner(Context* context) :
+    context_(context)
+{
+}
+
+void WorkQueueJobRunner::Run(unsigned count, void (*job)(void* data, unsigned index), void* data)
+{
+    WorkQueue* queue = context_->GetSubsystem<WorkQueue>();
+    if (nullptr == queue
+        || 0 == queue->GetNumThreads()
+        || count < 2)
+    {
+        for (unsigned i = 0; i < count; i ++)
+        {
+            job(data, i);
+        }
+        return;
+    }
+    // work items point into calls, so it's sized before any item is queued
+    calls_.Resize(count);
+    for (unsigned i = 0; i < count; i ++)
+    {
+        JobCall& call = calls_[i];
+        call.job_ = job;
+        call.data_ = data;
+        call.index_ = i;
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->workFunction_ = runJob;
+        item->start_ = &call;
+        item->priority_ = M_MAX_UNSIGNED;
+        queue->AddWorkItem(item);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+void WorkQueueJobRunner::runJob(const WorkItem* item, unsigned /*threadIndex*/)
+{
+    const JobCall* call = static_cast<const JobCall*>(item->start_);
+    call->job_(call->data_, call->index_);
+}
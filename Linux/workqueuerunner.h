@@ -0,0 +1,50 @@
+//
+// Copyright (c) 2008-2017 the Arkanoid project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/WorkQueue.h>
+
+#include "gamecore.h"
+
+using namespace Urho3D;
+
+/// Runs game core jobs on Urho3D WorkQueue, main thread works on them too while it waits. Call from main thread only.
+class WorkQueueJobRunner : public GameJobRunner
+{
+public:
+    WorkQueueJobRunner(Context* context);
+    virtual void Run(unsigned count, void (*job)(void* data, unsigned index), void* data);
+
+private:
+    /// Arguments of one job call.
+    struct JobCall
+    {
+        void (*job_)(void* data, unsigned index);
+        void* data_;
+        unsigned index_;
+    };
+    static void runJob(const WorkItem* item, unsigned threadIndex);
+
+    Context* context_;
+    PODVector<JobCall> calls_;
+};